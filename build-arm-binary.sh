@@ -25,21 +25,24 @@ echo ""
 echo "Build complete! Extracting binary..."
 echo ""
 
-# Create output directory
+# Create output directory (standalone dist dir: no onefile
+# self-extraction cost on every daemon start)
+rm -rf dist/kindle-ble-hid.dist
 mkdir -p dist
 
-# Extract the binary from the container
+# Extract the distribution directory from the container
 CONTAINER_ID=$(docker create kindle-ble-hid-builder)
-docker cp "$CONTAINER_ID:/build/kindle-ble-hid" ./dist/
+docker cp "$CONTAINER_ID:/build/daemon.dist" ./dist/kindle-ble-hid.dist
 docker rm "$CONTAINER_ID"
 
-echo "ARM binary created at: ./dist/kindle-ble-hid"
+echo "ARM distribution created at: ./dist/kindle-ble-hid.dist/"
 echo ""
 
 # Show binary info
-file ./dist/kindle-ble-hid
-ls -lh ./dist/kindle-ble-hid
+file ./dist/kindle-ble-hid.dist/kindle-ble-hid
+du -sh ./dist/kindle-ble-hid.dist
 
 echo ""
 echo "To deploy to Kindle:"
-echo "  scp ./dist/kindle-ble-hid kindle:/mnt/us/bumble_ble_hid/"
+echo "  scp -r ./dist/kindle-ble-hid.dist kindle:/mnt/us/bumble_ble_hid/"
+echo "  (start via: /mnt/us/bumble_ble_hid/kindle-ble-hid.dist/kindle-ble-hid)"
@@ -10,12 +10,14 @@ Author: Lucas Zampieri <lzampier@redhat.com>
 
 import json
 import os
-import subprocess
 import time
 from typing import Dict, Optional
 
 from config import config
 from logging_utils import log
+from metrics import metrics, STAGE_DECODE, STAGE_DISPATCH, STAGE_TOTAL
+from script_executor import ScriptExecutorPool, script_supervisor
+from uhid_output import UHIDKeyboard, usage_for
 from devices.base import ButtonMapper
 from devices.ble_m3 import BLEM3Mapper
 
@@ -44,11 +46,155 @@ class ButtonHandler:
         self.mapper = mapper or BLEM3Mapper()
         self.button_scripts: Dict[str, str] = {}
         self.debounce_ms = config.debounce_ms
+        self.repeat_ms = config.repeat_ms
+        self.coalesce_ms = config.coalesce_ms
         self.log_button_presses = config.log_button_presses
-        self.last_execution_time = 0.0
+
+        # Coalescing front-end state: the button byte of the last report
+        # that went through the mapper, and when it first did
+        self._last_state_byte = None
+        self._last_state_at = 0.0
+
+        # Per-button-code last execution times (monotonic clock, so an
+        # NTP step can't freeze or double-fire the gate)
+        self._last_exec: Dict[int, float] = {}
+
+        # Buttons that have fired without a release frame since: only
+        # these are throttled by repeat_ms (a deliberate re-press after
+        # a release is gated by debounce_ms alone)
+        self._held: set = set()
+
+        # Compiled dispatch tables (built by _compile_dispatch)
+        self._script_by_code: Dict[int, str] = {}
+        self._key_by_code: Dict[int, int] = {}
+        self._direct_actions: Dict[int, tuple] = {}
+
+        # Report decoder compiled from the device's report map (set by
+        # the host after connect); None falls back to fixed offsets
+        self._decoder = None
+
+        # Raw report capture file (opened lazily when capture_reports is
+        # enabled; feeds replay_reports.py)
+        self._capture_file = None
 
         self._load_config()
 
+        # Dispatch backends (created by ensure_backends)
+        self.uhid = None
+        self.executor_pool = None
+        self.ensure_backends()
+
+    def ensure_backends(self):
+        """Create whichever dispatch backends are missing.
+
+        - UHID keyboard: keystroke-mapped buttons (page turns) are
+          injected straight into the kernel instead of going through a
+          shell script. Unavailable UHID (older kernel, missing node)
+          just means those buttons use their script fallback.
+        - Pre-forked executor pool: per-press cost is one pipe write
+          instead of fork+exec of /bin/sh (80-150ms on the Kindle).
+
+        Idempotent. Called at construction, after a SIGHUP reload, and
+        on every reconnect: a full host teardown (Kindle resume, forced
+        cleanup after a cycle timeout) shuts the backends down, but the
+        sessions persist across cycles, so the backends must come back
+        with the connection or every press degrades to the slow
+        supervised-spawn path for the rest of the daemon's life.
+        """
+        if config.uhid_output and self._key_by_code and not self.uhid:
+            keyboard = UHIDKeyboard()
+            try:
+                keyboard.create()
+                self.uhid = keyboard
+            except OSError as e:
+                log.warning(f"UHID backend unavailable, "
+                            f"using scripts for all buttons: {e}")
+
+        if (config.use_executor_pool and self._script_by_code
+                and not self.executor_pool):
+            try:
+                self.executor_pool = ScriptExecutorPool(self._script_by_code)
+                self.executor_pool.start()
+            except OSError as e:
+                log.warning(f"Executor pool unavailable, "
+                            f"falling back to direct spawn: {e}")
+                self.executor_pool = None
+
+    def _compile_dispatch(self):
+        """Fuse the mapper and button_config.json into flat int-keyed tables.
+
+        Script paths are resolved and stat'ed once here, and the mapper's
+        movement-independent states are precompiled, so the hot path is a
+        couple of dict lookups with no hex formatting or filesystem
+        access per press.
+        """
+        script_by_code = {}
+        key_by_code = {}
+        for button_hex, action in self.button_scripts.items():
+            try:
+                code = int(button_hex, 16)
+            except ValueError:
+                log.warning(f"Ignoring invalid button code: {button_hex}")
+                continue
+
+            # Actions come in two forms: a plain script path, or an
+            # object with "key" (injected via UHID) and an optional
+            # "script" fallback for kernels without UHID
+            if isinstance(action, dict):
+                key_name = action.get('key')
+                script_path = action.get('script')
+                if key_name:
+                    usage = usage_for(key_name)
+                    if usage is not None:
+                        key_by_code[code] = usage
+                    else:
+                        log.warning(f"Unknown key name for button "
+                                    f"{button_hex}: {key_name}")
+            else:
+                script_path = action
+
+            if not script_path:
+                continue
+            if not os.path.exists(script_path):
+                log.error(f"Script not found (button {button_hex} disabled): "
+                          f"{script_path}")
+                continue
+            script_by_code[code] = script_path
+
+        direct_actions = dict(self.mapper.direct_mappings())
+
+        # Swap whole tables at once; the hot path never sees a half-built
+        # dispatch state
+        self._script_by_code = script_by_code
+        self._key_by_code = key_by_code
+        self._direct_actions = direct_actions
+
+        log.info(f"Compiled dispatch table: {len(direct_actions)} direct "
+                 f"states, {len(script_by_code)} scripts, "
+                 f"{len(key_by_code)} keystrokes")
+
+    def set_decoder(self, decoder):
+        """Install a compiled report decoder (see hid_decoder.py)."""
+        self._decoder = decoder
+        # The button byte may sit at a different offset now; don't let
+        # a stale value coalesce away the first report
+        self._last_state_byte = None
+
+    def shutdown(self):
+        """Release resources (stops the executor pool worker)."""
+        if self.executor_pool:
+            self.executor_pool.stop()
+            self.executor_pool = None
+        if self.uhid:
+            self.uhid.close()
+            self.uhid = None
+        if self._capture_file:
+            try:
+                self._capture_file.close()
+            except OSError:
+                pass
+            self._capture_file = None
+
     def _load_config(self):
         """Load button-to-script mappings from JSON config."""
         try:
@@ -57,6 +203,7 @@ class ButtonHandler:
 
             self.button_scripts = cfg.get('buttons', {})
             self.debounce_ms = cfg.get('debounce_ms', self.debounce_ms)
+            self.repeat_ms = cfg.get('repeat_ms', self.repeat_ms)
             self.log_button_presses = cfg.get('log_button_presses',
                                                self.log_button_presses)
 
@@ -74,39 +221,135 @@ class ButtonHandler:
             log.error(f"Error parsing config file: {e}")
             log.warning("Using default empty configuration")
 
-    def handle_report(self, report_data: bytes) -> bool:
+        self._compile_dispatch()
+
+    def reload(self):
+        """Re-apply configuration without touching the BLE connection.
+
+        Called on SIGHUP: refreshes the config.ini-derived timing
+        values, re-reads button_config.json, and recompiles the
+        dispatch tables (the compiled tables swap atomically, so this
+        is safe mid-session). The executor pool worker froze the old
+        script table at fork time, so it is re-forked; the UHID
+        keyboard follows the presence of keystroke mappings. The
+        connection, decoder, and debounce history are untouched.
+        """
+        self.debounce_ms = config.debounce_ms
+        self.repeat_ms = config.repeat_ms
+        self.coalesce_ms = config.coalesce_ms
+        self.log_button_presses = config.log_button_presses
+        self._load_config()
+
+        if self.uhid and not (config.uhid_output and self._key_by_code):
+            self.uhid.close()
+            self.uhid = None
+
+        if self.executor_pool:
+            if config.use_executor_pool and self._script_by_code:
+                try:
+                    self.executor_pool.restart(self._script_by_code)
+                except OSError as e:
+                    log.warning(f"Executor pool unavailable, "
+                                f"falling back to direct spawn: {e}")
+                    self.executor_pool = None
+            else:
+                self.executor_pool.stop()
+                self.executor_pool = None
+
+        self.ensure_backends()
+
+    def handle_report(self, report_data: bytes,
+                      received_at: Optional[float] = None) -> bool:
         """Process an HID report and execute script if appropriate.
 
         Args:
             report_data: Raw HID report bytes
+            received_at: Monotonic timestamp of notification arrival
+                (used for end-to-end latency attribution)
 
         Returns:
             True if a script was executed, False otherwise
         """
+        if received_at is None:
+            received_at = time.monotonic()
+        metrics.incr('reports_received')
+
+        if config.capture_reports:
+            self._capture_report(report_data, received_at)
+
         # Need at least report_id and button_state
         if len(report_data) < 2:
             return False
 
-        # Extract fields from report
-        button_state = report_data[1]
-        x_movement = report_data[2] if len(report_data) > 2 else 0
-        y_movement = report_data[3] if len(report_data) > 3 else 0
+        # Coalescing front-end: single byte test, no decode or mapper
+        # work. A wheel-drag burst delivers dozens of reports per second
+        # that either carry the release state (pure X/Y chatter) or
+        # repeat the same button byte; drop the former outright and let
+        # one report per coalesce window through for the latter. The
+        # window stays well under repeat_ms, so a held button still
+        # feeds the debounce/repeat gate with fresh frames. The compiled
+        # decoder knows where the button byte sits; byte 1 is only
+        # correct for the fixed fallback layout (on a standard HOGP
+        # report without the ID prefix it is the X axis, and reading it
+        # as the button byte drops press-without-movement reports)
+        now = time.monotonic()
+        if self._decoder:
+            button_index = self._decoder.button_byte_index(report_data)
+        else:
+            button_index = 1
+
+        if button_index is not None:
+            state_byte = report_data[button_index]
+
+            if self.mapper.is_release_event(state_byte):
+                metrics.incr('movement_drops')
+                self._last_state_byte = state_byte
+                self._held.clear()
+                return False
+
+            if (state_byte == self._last_state_byte
+                    and (now - self._last_state_at) * 1000.0
+                    < self.coalesce_ms):
+                metrics.incr('reports_coalesced')
+                return False
+            self._last_state_byte = state_byte
+            self._last_state_at = now
+
+        # Extract fields via the compiled report-map decoder when
+        # available; fall back to the BLE-M3's fixed layout otherwise
+        decoded = self._decoder.decode(report_data) if self._decoder else None
+        if decoded is not None:
+            button_state, x_movement, y_movement = decoded
+        else:
+            button_state = report_data[1]
+            x_movement = report_data[2] if len(report_data) > 2 else 0
+            y_movement = report_data[3] if len(report_data) > 3 else 0
 
         # Ignore release events
         if self.mapper.is_release_event(button_state):
+            self._held.clear()
             return False
 
-        # Map to standardized button code
-        button_code, button_name = self.mapper.map(
-            button_state, x_movement, y_movement
-        )
+        # Compiled direct table first: movement-independent states skip
+        # the mapper entirely
+        direct = self._direct_actions.get(button_state)
+        if direct is not None:
+            button_code, button_name = direct
+        else:
+            button_code, button_name = self.mapper.map(
+                button_state, x_movement, y_movement
+            )
 
         # Ignore unrecognized/noise patterns
         if button_code is None:
             return False
 
+        # Decode stage complete: notification arrival -> mapped button
+        metrics.record_latency(STAGE_DECODE, time.monotonic() - received_at)
+
         # Apply debouncing
-        if not self._debounce_check():
+        if not self._debounce_check(button_code):
+            metrics.incr('debounce_drops')
             return False
 
         # Log the button press with raw data
@@ -116,57 +359,121 @@ class ButtonHandler:
                     f"x:{x_movement:02x}, y:{y_movement:02x})")
 
         # Execute the script
-        return self._execute_script(button_code, button_name)
+        return self._execute_script(button_code, button_name, received_at)
 
-    def _debounce_check(self) -> bool:
-        """Check if enough time has passed since last execution.
+    def _capture_report(self, report_data: bytes, received_at: float):
+        """Append a raw report to the capture file.
 
-        Returns:
-            True if we should proceed, False if debouncing
+        One "<monotonic_ts> <hex>" line per report; replay with
+        replay_reports.py. Line-buffered so a crash loses at most the
+        last report. Capture disables itself if the file can't be
+        written (read-only filesystem etc.).
         """
-        current_time = time.time()
-        debounce_sec = self.debounce_ms / 1000.0
+        try:
+            if self._capture_file is None:
+                self._capture_file = open(config.capture_file, 'a', buffering=1)
+                log.info(f"Capturing raw reports to {config.capture_file}")
+            self._capture_file.write(f"{received_at:.6f} {report_data.hex()}\n")
+        except OSError as e:
+            log.warning(f"Report capture disabled: {e}")
+            config.capture_reports = False
+            self._capture_file = None
+
+    def _debounce_check(self, button_code: int) -> bool:
+        """Per-button execution gate using the monotonic clock.
+
+        Each button code is gated independently, so pressing Next then
+        immediately Brightness-Up no longer drops the second press.
+        Bounces of the same button inside debounce_ms are dropped, and a
+        held button re-fires at most every repeat_ms (auto-repeat; set
+        repeat_ms to 0 to let holds re-fire at the debounce rate). The
+        repeat gate only applies while the button is held - a release
+        frame clears the held mark, so a deliberate re-press is gated by
+        debounce_ms alone.
 
-        if current_time - self.last_execution_time < debounce_sec:
-            return False
+        Args:
+            button_code: Standardized button code being executed
 
-        self.last_execution_time = current_time
+        Returns:
+            True if we should proceed, False if debouncing
+        """
+        now = time.monotonic()
+        last = self._last_exec.get(button_code)
+
+        if last is not None:
+            elapsed_ms = (now - last) * 1000.0
+            if elapsed_ms < self.debounce_ms:
+                return False
+            if (self.repeat_ms and button_code in self._held
+                    and elapsed_ms < self.repeat_ms):
+                return False
+
+        self._last_exec[button_code] = now
+        self._held.add(button_code)
         return True
 
-    def _execute_script(self, button_code: int, button_name: str) -> bool:
+    def _execute_script(self, button_code: int, button_name: str,
+                        received_at: Optional[float] = None) -> bool:
         """Execute the script mapped to a button code.
 
         Args:
             button_code: Standardized button code (0x01, 0x02, etc.)
             button_name: Human-readable button name for logging
+            received_at: Monotonic timestamp of notification arrival
+                (for end-to-end latency attribution)
 
         Returns:
             True if script was executed, False otherwise
         """
-        button_hex = f"0x{button_code:02x}"
-        script_path = self.button_scripts.get(button_hex)
+        # Fastest path: keystroke-mapped buttons go straight into the
+        # kernel through the UHID keyboard (two fd writes); on failure
+        # the backend disables itself and we fall through to the script
+        if self.uhid and button_code in self._key_by_code:
+            launch_start = time.monotonic()
+            if self.uhid.press(self._key_by_code[button_code]):
+                launched = time.monotonic()
+                metrics.record_latency(STAGE_DISPATCH, launched - launch_start)
+                if received_at is not None:
+                    metrics.record_latency(STAGE_TOTAL, launched - received_at)
+                metrics.incr('uhid_injections')
+                log.success(f"Injected {button_name} via UHID")
+                return True
+            if self.uhid.fd is None:
+                self.uhid = None
+
+        # Fast path: hand the press to the pre-forked executor pool
+        if self.executor_pool:
+            launch_start = time.monotonic()
+            dispatched = self.executor_pool.dispatch(button_code)
+            launched = time.monotonic()
+            if dispatched:
+                metrics.record_latency(STAGE_DISPATCH, launched - launch_start)
+                if received_at is not None:
+                    metrics.record_latency(STAGE_TOTAL, launched - received_at)
+                metrics.incr('scripts_executed')
+                log.success(f"Dispatched {button_name} to executor pool")
+            return dispatched
+
+        # Compiled table: int lookup, path already stat'ed at load time
+        script_path = self._script_by_code.get(button_code)
 
         if not script_path:
-            log.warning(f"No script configured for button {button_hex}")
+            log.warning(f"No script configured for button 0x{button_code:02x}")
             return False
 
-        if not os.path.exists(script_path):
-            log.error(f"Script not found: {script_path}")
+        # Supervised launch: output drained into the log, child reaped,
+        # runtime/exit status recorded, in-flight count capped
+        launch_start = time.monotonic()
+        if not script_supervisor.launch(script_path, button_name):
             return False
 
-        try:
-            subprocess.Popen(
-                [script_path],
-                stdout=subprocess.PIPE,
-                stderr=subprocess.PIPE,
-                start_new_session=True  # Detach from parent
-            )
-            log.success(f"Executed: {script_path}")
-            return True
-
-        except Exception as e:
-            log.error(f"Failed to execute script: {e}")
-            return False
+        launched = time.monotonic()
+        metrics.record_latency(STAGE_DISPATCH, launched - launch_start)
+        if received_at is not None:
+            metrics.record_latency(STAGE_TOTAL, launched - received_at)
+        metrics.incr('scripts_executed')
+        log.success(f"Launched: {script_path}")
+        return True
 
     def execute_disconnect_script(self):
         """Execute the reading end script on disconnection."""
@@ -176,15 +483,6 @@ class ButtonHandler:
             log.warning(f"Reading end script not found: {script_path}")
             return
 
-        try:
-            log.info(f"Executing reading end script: {script_path}")
-            subprocess.Popen(
-                [script_path],
-                stdout=subprocess.PIPE,
-                stderr=subprocess.PIPE,
-                start_new_session=True
-            )
+        log.info(f"Executing reading end script: {script_path}")
+        if script_supervisor.launch(script_path, 'reading end'):
             log.success("Reading end script launched")
-
-        except Exception as e:
-            log.error(f"Failed to execute reading end script: {e}")
@@ -10,7 +10,7 @@ Author: Lucas Zampieri <lzampier@redhat.com>
 
 import configparser
 import os
-from typing import Optional
+from typing import List, Optional
 
 __all__ = ['config', 'Config']
 
@@ -56,6 +56,22 @@ class Config:
         self.reading_end_script = os.path.join(self.scripts_dir, 'readingEnd.sh')
         self.log_file = self._get('logging', 'log_file',
                                   '/var/log/ble_hid_daemon.log')
+        # Batch log writes from a background thread instead of a
+        # synchronous write per record inside the event loop
+        self.log_buffered = self._getbool('logging', 'buffered_writes', True)
+        # Size-capped rotation: once the log passes log_max_kb it is
+        # gzip'd aside (log_backup_count compressed predecessors kept)
+        # so /var/log on the small rootfs stays bounded (0 disables)
+        self.log_max_kb = self._getint('logging', 'log_max_kb', 1024)
+        self.log_backup_count = self._getint('logging', 'log_backup_count', 3)
+
+        # Event-loop stall watchdog: sample loop scheduling latency every
+        # stall_poll_ms and log the blocking stack when a stall exceeds
+        # stall_threshold_ms (attributes latency spikes to sync I/O in
+        # our own process vs. the radio or the remote)
+        self.loop_watchdog = self._getbool('logging', 'loop_watchdog', True)
+        self.stall_poll_ms = self._getint('logging', 'stall_poll_ms', 100)
+        self.stall_threshold_ms = self._getint('logging', 'stall_threshold_ms', 250)
 
         # Transport
         self.transport = self._get('transport', 'hci_transport',
@@ -63,11 +79,44 @@ class Config:
 
         # Connection timeouts (seconds)
         self.reconnect_delay = self._getint('connection', 'reconnect_delay', 5)
+        # Adaptive reconnect scheduler: short aggressive retries right
+        # after an unexpected disconnect, exponential decay toward
+        # reconnect_delay_max while the remote stays absent, instant
+        # reset once it advertises again (false = flat reconnect_delay)
+        self.adaptive_reconnect = self._getbool('connection', 'adaptive_reconnect', True)
+        self.reconnect_delay_max = self._getint('connection', 'reconnect_delay_max', 300)
+        self.reconnect_aggressive_delay = self._getint('connection', 'reconnect_aggressive_delay', 1)
+        self.reconnect_aggressive_attempts = self._getint('connection', 'reconnect_aggressive_attempts', 6)
         self.cycle_timeout = self._getint('connection', 'cycle_timeout', 90)
         self.hci_reset_timeout = self._getint('connection', 'hci_reset_timeout', 10)
         self.connect_timeout = self._getint('connection', 'connect_timeout', 30)
         self.transport_timeout = self._getint('connection', 'transport_timeout', 30)
 
+        # Persistent transport: keep /dev/stpbt open and the device powered
+        # across reconnect cycles, probing controller liveness instead of
+        # re-running the full open/reset/power-on sequence every time
+        self.persistent_transport = self._getbool('connection', 'persistent_transport', True)
+        self.liveness_probe_timeout = self._getint('connection', 'liveness_probe_timeout', 3)
+
+        # Scan-gated connect: passively scan for the target and fire the
+        # connect the instant its advertisement is seen, instead of
+        # holding a blind connect for up to connect_timeout
+        self.scan_before_connect = self._getbool('connection', 'scan_before_connect', True)
+
+        # Controller-managed auto-connect: program the target into the
+        # HCI filter accept list and let the radio latch the connection
+        # itself when the remote advertises (zero host CPU during the
+        # wait; supersedes the host-side scan while enabled). Falls back
+        # to direct connect if the stack lacks accept-list support
+        self.auto_connect = self._getbool('connection', 'auto_connect', True)
+
+        # Resume detection: watch for wall-clock vs monotonic-clock
+        # divergence (the monotonic clock halts during suspend) and force
+        # an immediate BT re-init instead of waiting out cycle_timeout
+        self.resume_detection = self._getbool('connection', 'resume_detection', True)
+        self.resume_poll_interval = self._getint('connection', 'resume_poll_interval', 2)
+        self.resume_gap_threshold = self._getint('connection', 'resume_gap_threshold', 5)
+
         # BLE connection parameters (for battery optimization)
         # Connection interval in ms (7.5-4000ms, higher = less power, more latency)
         # 100ms is a good balance for HID devices that don't need constant updates
@@ -80,14 +129,87 @@ class Config:
         # How long before connection is considered lost if no response
         self.supervision_timeout = self._getint('ble_power', 'supervision_timeout', 5000)
 
+        # Adaptive profile switching: request a fast interval the moment a
+        # report arrives and fall back to the power profile after an idle
+        # window, so page turns during active reading land in <50ms while
+        # idle battery cost stays at the power-profile level
+        self.adaptive_connection_params = self._getbool('ble_power', 'adaptive_connection_params', True)
+        self.fast_interval_min = self._getint('ble_power', 'fast_interval_min', 15)
+        self.fast_interval_max = self._getint('ble_power', 'fast_interval_max', 30)
+        # Seconds without input before reverting to the power profile
+        self.fast_idle_timeout = self._getint('ble_power', 'fast_idle_timeout', 20)
+
         # Button handling
         self.debounce_ms = self._getint('buttons', 'debounce_ms', 200)
+        # Merge window for the coalescing front-end: consecutive reports
+        # carrying the same button byte inside this window run the
+        # decoder/mapper once instead of per notification (0 disables).
+        # Must stay well under repeat_ms or held-button auto-repeat slows
+        self.coalesce_ms = self._getint('buttons', 'coalesce_ms', 50)
+        # Minimum interval between repeats of the *same* button while it
+        # is held (0 = repeat at the debounce rate)
+        self.repeat_ms = self._getint('buttons', 'repeat_ms', 600)
         self.log_button_presses = self._getbool('buttons', 'log_button_presses', True)
+        # Pre-forked executor pool for button scripts (avoids per-press
+        # fork+exec of the 30MB daemon process)
+        self.use_executor_pool = self._getbool('buttons', 'use_executor_pool', True)
+        # Script supervision (non-pool path): cap on concurrently
+        # running action scripts, and how long one may run before the
+        # supervisor kills it to free its slot
+        self.max_inflight_scripts = self._getint('buttons', 'max_inflight_scripts', 4)
+        self.script_timeout = self._getint('buttons', 'script_timeout', 30)
+        # UHID output backend: inject keystroke-mapped buttons directly
+        # into the kernel instead of spawning their scripts (buttons with
+        # a "key" entry in button_config.json; falls back to scripts if
+        # /dev/uhid is unavailable)
+        self.uhid_output = self._getbool('buttons', 'uhid_output', True)
+        # Record raw HID reports to capture_file for offline replay
+        # through replay_reports.py (leave off in normal use)
+        self.capture_reports = self._getbool('buttons', 'capture_reports', False)
+        self.capture_file = self._get('paths', 'capture_file',
+                                      f'{self.cache_dir}/report_capture.log')
+
+        # HCI trace ring: keep the last hci_trace_packets HCI packets in
+        # memory and write them as a btsnoop file (Wireshark-readable)
+        # on SIGUSR2 or when a connection cycle fails with the device in
+        # sight - btmon isn't available on the Kindle
+        self.hci_trace = self._getbool('logging', 'hci_trace', True)
+        self.hci_trace_packets = self._getint('logging', 'hci_trace_packets', 2048)
+        self.hci_trace_file = self._get('paths', 'hci_trace_file',
+                                        f'{self.cache_dir}/hci_trace.btsnoop')
+
+        # Metrics endpoint: local Unix socket serving a JSON snapshot of
+        # counters, latency histograms, and per-device session state
+        # (queried by `just metrics` / metrics_server.py)
+        self.metrics_server = self._getbool('logging', 'metrics_server', True)
+        self.metrics_socket = self._get('paths', 'metrics_socket',
+                                        '/var/run/ble_hid_metrics.sock')
+
+        # Memory footprint tracking for long deployments on the 256MB
+        # Kindle: periodic RSS sampling (logged and exported as the
+        # rss_kb gauge) and a gated gc.collect() at cycle boundaries so
+        # discarded Bumble stacks are reclaimed promptly instead of
+        # whenever the collector happens to run
+        self.rss_sampling = self._getbool('memory', 'rss_sampling', True)
+        self.rss_sample_interval = self._getint('memory', 'rss_sample_interval', 300)
+        self.gc_after_cycle = self._getbool('memory', 'gc_after_cycle', True)
 
         # Device identity
         self.device_name = self._get('device', 'name', 'Kindle-BLE-HID')
         self.device_address = self._get('device', 'address', 'F0:F0:F0:F0:F0:F0')
 
+    def reload(self):
+        """Re-read config.ini in place (SIGHUP hot reload).
+
+        The singleton's attributes are replaced, so everything that
+        reads config per use (debounce gates, scheduler delays, script
+        supervision limits) picks the new values up immediately.
+        Settings consumed once at startup - transport spec, watchdog
+        and metrics-server switches, persistent transport - still need
+        a daemon restart to change.
+        """
+        self._load()
+
     def _get(self, section: str, key: str, default: str) -> str:
         """Get string value from config"""
         try:
@@ -109,18 +231,32 @@ class Config:
         except (configparser.NoSectionError, configparser.NoOptionError, ValueError):
             return default
 
-    def get_device_address(self) -> Optional[str]:
-        """Load device address from devices.conf"""
+    def get_device_addresses(self) -> List[str]:
+        """Load all device addresses from devices.conf (one per line).
+
+        Every non-comment line is a device the daemon should maintain a
+        connection to (e.g. page turner plus foot pedal).
+        """
         if not os.path.exists(self.devices_config_file):
-            return None
+            return []
 
+        addresses = []
         with open(self.devices_config_file, 'r') as f:
             for line in f:
                 line = line.strip()
-                if line and not line.startswith('#'):
-                    return line
+                if line and not line.startswith('#') and line not in addresses:
+                    addresses.append(line)
+
+        return addresses
+
+    def get_device_address(self) -> Optional[str]:
+        """Load the first device address from devices.conf.
 
-        return None
+        Single-device callers (main.py, cache tooling) only care about
+        the primary entry.
+        """
+        addresses = self.get_device_addresses()
+        return addresses[0] if addresses else None
 
 
 # Global singleton instance
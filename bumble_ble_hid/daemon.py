@@ -2,123 +2,253 @@
 """
 BLE HID Daemon - Persistent connection manager
 
-Automatically connects to a configured BLE HID device and maintains
-persistent connection with auto-reconnect.
+Automatically connects to the configured BLE HID devices and maintains
+persistent connections with auto-reconnect. All devices share one HCI
+transport and one BLEHIDHost; each gets its own reconnect state machine.
 
 Configuration file: /mnt/us/bumble_ble_hid/devices.conf
-Format: Single device address (first non-comment line)
+Format: One device address per non-comment line
 
 Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
-__version__ = "2.1.0"  # Fixed connection timeout to only apply during establishment
+__version__ = "2.4.0"  # Concurrent per-device reconnect loops on one host
 
 import asyncio
+import gc
 import logging
 import signal
 import sys
+import threading
+import time
+import traceback
 
 # Add the bumble_ble_hid directory to path for Kindle deployment
 sys.path.insert(0, '/mnt/us/bumble_ble_hid')
 
 from config import config
-from logging_utils import setup_daemon_logging
+from logging_utils import setup_daemon_logging, flush_logs
+from metrics import metrics
+from metrics_server import MetricsServer
+from reconnect_scheduler import ReconnectScheduler
 from host import BLEHIDHost
 
 __all__ = ['BLEHIDDaemon', '__version__']
 
 logger = logging.getLogger(__name__)
 
+# Post-cycle GC never runs more often than this (aggressive 1s
+# reconnect retries would otherwise collect every cycle for nothing)
+_GC_MIN_INTERVAL = 30.0
+
+
+def _read_rss_kb() -> int:
+    """Current resident set size in kB (VmRSS from /proc/self/status)."""
+    try:
+        with open('/proc/self/status') as f:
+            for line in f:
+                if line.startswith('VmRSS:'):
+                    return int(line.split()[1])
+    except (OSError, ValueError, IndexError):
+        pass
+    return 0
+
 
 class BLEHIDDaemon:
-    """Daemon that maintains persistent connection to a BLE HID device.
+    """Daemon that maintains persistent connections to BLE HID devices.
 
     Features:
-    - Auto-reconnect on disconnection
+    - One shared host/transport, N concurrent device connections
+    - Independent auto-reconnect state machine per device
     - Connection establishment timeout (does not affect idle connections)
     - Exponential backoff on repeated timeouts
     - Graceful shutdown handling
     """
 
     def __init__(self):
-        self.device_address = None
+        self.device_addresses = []
         self.running = False
         self.host = None
-        self.consecutive_timeouts = 0
-
-    def load_device(self) -> bool:
-        """Load device address from config file.
+        self.consecutive_timeouts = {}  # address -> count
+        self._loop_tasks = {}  # address -> device reconnect-loop task
+        # Adaptive per-device reconnect delays (replaces the old flat
+        # reconnect_delay sleep; state persists across restarts)
+        self.reconnect = ReconnectScheduler()
+        self._cycle_tasks = {}  # address -> in-flight cycle task
+        self._resume_task = None
+        # Bumped by the resume watcher; device loops compare against the
+        # generation their cycle started under to tell a resume abort
+        # from a real cancellation
+        self._resume_generation = 0
+        self._reset_generation = 0
+        self._reset_lock = asyncio.Lock()
+        self._watchdog_task = None
+        self._loop_heartbeat = 0.0  # last time the event loop ran the watchdog
+        self._metrics_server = None
+        self._rss_task = None
+        self._rss_baseline_kb = 0
+        self._last_gc = 0.0
+        # Startup-phase profile (logged at boot)
+        self._started_at = 0.0
+        self._first_connection_logged = False
+
+    def load_devices(self) -> bool:
+        """Load device addresses from config file.
 
         Returns:
-            True if device address loaded successfully
+            True if at least one device address loaded successfully
         """
-        self.device_address = config.get_device_address()
+        self.device_addresses = config.get_device_addresses()
 
-        if not self.device_address:
+        if not self.device_addresses:
             logger.error(f"No device address found in {config.devices_config_file}")
             return False
 
-        logger.info(f"Loaded device: {self.device_address}")
+        for address in self.device_addresses:
+            logger.info(f"Loaded device: {address}")
         return True
 
     async def run(self):
-        """Main daemon loop with auto-reconnect."""
+        """Main daemon entry: one reconnect loop per configured device."""
         self.running = True
+        self._started_at = time.monotonic()
 
-        if not self.load_device():
+        # Config and devices.conf are validated before the Bumble stack
+        # is imported (host construction below), so a misconfigured
+        # daemon exits in milliseconds instead of after seconds of
+        # module loading
+        if not self.load_devices():
             logger.error("Failed to load device configuration")
             return
 
         logger.info(f"BLE HID Daemon v{__version__}")
-        logger.info(f"Device: {self.device_address}")
+        logger.info(f"Devices: {', '.join(self.device_addresses)}")
         logger.info(f"Transport: {config.transport}")
+        logger.info(f"Startup: config validated in "
+                    f"{(time.monotonic() - self._started_at) * 1000:.0f}ms")
+
+        # One host for all devices: one transport, one HCI reset, one
+        # event loop - sessions multiplex over the shared radio.
+        # Constructing it triggers the deferred Bumble import
+        self.host = BLEHIDHost(config.transport)
+        logger.info(f"Startup: host ready in "
+                    f"{(time.monotonic() - self._started_at) * 1000:.0f}ms "
+                    f"(Bumble import {metrics.get('startup_import_ms')}ms)")
+
+        # Resume watcher cancels stale cycles the moment the Kindle
+        # wakes up instead of letting them run into the 90s cycle timeout
+        if config.resume_detection:
+            self._resume_task = asyncio.create_task(self._watch_for_resume())
+
+        # Stall watchdog attributes HID latency spikes to loop blockage
+        # (sync flash writes, log bursts) vs. the radio or the remote
+        if config.loop_watchdog:
+            self._watchdog_task = asyncio.create_task(self._watch_loop_stalls())
+
+        # RSS sampler: the evidence for (or against) flat memory over a
+        # multi-week soak
+        if config.rss_sampling:
+            self._rss_task = asyncio.create_task(self._sample_rss())
+
+        # Local metrics endpoint (`just metrics` polls it); serves the
+        # shared counters/histograms plus the daemon state below
+        if config.metrics_server:
+            self._metrics_server = MetricsServer(
+                extra_snapshot=self._metrics_snapshot
+            )
+            await self._metrics_server.start()
+
+        # Task table instead of a fixed gather so a SIGHUP reload can
+        # add and remove device loops while the daemon runs
+        self._loop_tasks = {
+            address: asyncio.create_task(self._device_loop(address))
+            for address in self.device_addresses
+        }
+        try:
+            while self._loop_tasks:
+                await asyncio.wait(set(self._loop_tasks.values()),
+                                   return_when=asyncio.FIRST_COMPLETED)
+                for address, task in list(self._loop_tasks.items()):
+                    if not task.done():
+                        continue
+                    del self._loop_tasks[address]
+                    if not task.cancelled() and task.exception():
+                        logger.error(f"[{address}] Device loop died: "
+                                     f"{task.exception()}")
+        finally:
+            if self._resume_task:
+                self._resume_task.cancel()
+                self._resume_task = None
+            if self._watchdog_task:
+                self._watchdog_task.cancel()
+                self._watchdog_task = None
+            if self._rss_task:
+                self._rss_task.cancel()
+                self._rss_task = None
+            if self._metrics_server:
+                await self._metrics_server.stop()
+                self._metrics_server = None
 
-        # Reconnection loop
-        while self.running:
-            try:
-                logger.info("=== Starting new connection attempt ===")
-                logger.info("Creating BLE HID host...")
-                self.host = BLEHIDHost(config.transport)
+        logger.info("Daemon stopped")
 
-                logger.info("Connecting to device...")
-                # Timeout only applies to connection establishment phase
-                # Once connected and waiting for HID reports, no timeout
-                await asyncio.wait_for(
-                    self.host.connect_and_setup(self.device_address),
-                    timeout=config.cycle_timeout
-                )
-                logger.info("Connection established, now waiting for HID reports...")
+    async def _device_loop(self, address: str):
+        """Reconnect state machine for one device.
 
-                # Reset timeout counter on successful connection
-                self.consecutive_timeouts = 0
+        Runs concurrently with the other devices' loops; only connection
+        establishment is serialized inside the host (single LE
+        create-connection on the controller).
+        """
+        while self.running:
+            generation = self._resume_generation
+            cycle_started = time.monotonic()
+            cycle = None
+            try:
+                logger.info(f"[{address}] === Starting new connection attempt ===")
 
-                # Wait indefinitely for disconnection (no timeout here)
-                await self.host.wait_for_disconnection()
-                logger.info("host.wait_for_disconnection() returned")
+                # Run the cycle as a task so the resume watcher can
+                # cancel it out from under a wedged BT controller
+                cycle = asyncio.create_task(self._connection_cycle(address))
+                self._cycle_tasks[address] = cycle
+                await cycle
 
-                # Connection ended normally
-                logger.info("Connection ended, will reconnect")
+                # Connection ended normally (unexpected disconnect from
+                # a live session): schedule aggressive retries, tempered
+                # by how strong the link was
+                logger.info(f"[{address}] Connection ended, will reconnect")
+                self.reconnect.note_disconnected(
+                    address, self.host.session(address).last_rssi)
 
             except asyncio.TimeoutError:
-                self.consecutive_timeouts += 1
+                count = self.consecutive_timeouts.get(address, 0) + 1
+                self.consecutive_timeouts[address] = count
                 logger.warning(
-                    f"Connection establishment timed out after {config.cycle_timeout}s "
-                    f"(consecutive: {self.consecutive_timeouts})"
+                    f"[{address}] Connection establishment timed out after "
+                    f"{config.cycle_timeout}s (consecutive: {count})"
                 )
-                logger.warning("BT hardware may be asleep - forcing transport cleanup")
-                await self._force_cleanup()
-
-                # Extended delay after multiple timeouts
-                if self.consecutive_timeouts >= 3:
-                    logger.warning("Multiple consecutive timeouts - waiting longer")
-                    await asyncio.sleep(config.reconnect_delay * 2)
-
-            except KeyboardInterrupt:
-                logger.info("Received interrupt signal")
-                break
+                self.reconnect.note_failure(
+                    address, advertised=self._advertised_since(address,
+                                                               cycle_started))
+                # A 90s stall is exactly what the trace ring exists for
+                self.host.dump_hci_trace(f"{address} cycle timeout")
+                # Only reset the shared radio when no other device is
+                # connected through it
+                if not self.host.any_connected():
+                    logger.warning("BT hardware may be asleep - forcing transport cleanup")
+                    await self._force_cleanup()
 
             except asyncio.CancelledError:
-                logger.info("Task cancelled")
+                if self._resume_generation != generation:
+                    # Cycle cancelled by the resume watcher: the first
+                    # loop to get here forces the transport closed (the
+                    # controller needs a real HCI reset after resume),
+                    # then everyone reconnects right away
+                    logger.warning(f"[{address}] Cycle aborted by resume watcher - "
+                                   "reconnecting now")
+                    await self._resume_reset()
+                    continue
+                if cycle and not cycle.done():
+                    cycle.cancel()
+                logger.info(f"[{address}] Task cancelled")
                 break
 
             except FileNotFoundError as e:
@@ -127,39 +257,344 @@ class BLEHIDDaemon:
                 break
 
             except Exception as e:
-                logger.error(f"Error in connection: {e}")
+                logger.error(f"[{address}] Error in connection: {e}")
                 logger.exception("Connection error details")
-                self.consecutive_timeouts = 0
-
-            # Clean up host
+                self.consecutive_timeouts[address] = 0
+                # "Device not advertising" escalates the backoff; a
+                # setup failure with the device in sight does not
+                advertised = self._advertised_since(address, cycle_started)
+                self.reconnect.note_failure(address, advertised=advertised)
+                # Setup failing while the device is in sight is the
+                # mysterious case worth a packet capture (a remote that
+                # simply isn't there would dump on every backoff cycle
+                # overnight and chew the flash)
+                if advertised and self.host:
+                    self.host.dump_hci_trace(f"{address} setup failed")
+
+            finally:
+                self._cycle_tasks.pop(address, None)
+
+            # Clean up this device's session; the shared transport stays
+            # open (persistent mode) unless no session needs it anymore
             if self.host:
-                logger.debug("Cleaning up host...")
+                logger.debug(f"[{address}] Cleaning up session...")
                 try:
-                    await self.host.cleanup()
-                    logger.debug("Host cleanup complete")
+                    await self.host.session(address).cleanup()
+                    if not config.persistent_transport and not self.host.any_connected():
+                        await self.host.cleanup(close_transport=True)
+                    logger.debug(f"[{address}] Session cleanup complete")
                 except Exception as e:
-                    logger.error(f"Cleanup error: {e}")
-                self.host = None
+                    logger.error(f"[{address}] Cleanup error: {e}")
+
+            # Push buffered log records out at the cycle boundary so the
+            # tail of a disconnect is on disk even if we crash later
+            flush_logs()
+
+            # Cycle boundary is the one place a collection is cheap:
+            # nothing latency-sensitive in flight, and the objects the
+            # cycle retired (old connection, possibly a whole Bumble
+            # Device after a transport re-init) are freshly unreachable
+            if config.gc_after_cycle:
+                self._collect_cycle_garbage()
 
             if not self.running:
-                logger.info("Daemon stopping, exiting reconnection loop")
+                logger.info(f"[{address}] Daemon stopping, exiting reconnection loop")
                 break
 
-            # Wait before reconnecting
-            logger.info(f"Waiting {config.reconnect_delay} seconds before reconnection...")
-            await asyncio.sleep(config.reconnect_delay)
+            # Wait before reconnecting (scheduler: aggressive after a
+            # drop, backed off while the remote stays absent)
+            delay = self.reconnect.next_delay(address)
+            logger.info(f"[{address}] Waiting {delay:.0f} seconds "
+                        "before reconnection...")
+            await asyncio.sleep(delay)
 
-        logger.info("Daemon stopped")
+    def _advertised_since(self, address: str, since: float) -> bool:
+        """Whether the targeted scan saw the device during this cycle.
+
+        Seeing the advertisement means the remote is present - the
+        scheduler resets to the base cadence instead of backing off,
+        regardless of why the rest of the cycle failed.
+        """
+        if not self.host:
+            return False
+        return self.host.session(address).last_adv_at >= since
+
+    async def _connection_cycle(self, address: str):
+        """One connect-and-serve cycle (cancellable by the resume watcher)."""
+        logger.info(f"[{address}] Connecting to device...")
+        metrics.incr('connection_attempts')
+        await self.host.start()
+        session = self.host.session(address)
+
+        # Timeout only applies to connection establishment phase
+        # Once connected and waiting for HID reports, no timeout
+        await asyncio.wait_for(
+            session.connect_and_setup(),
+            timeout=config.cycle_timeout
+        )
+        logger.info(f"[{address}] Connection established, now waiting for HID reports...")
+
+        # Reset timeout counter and backoff on successful connection
+        metrics.incr('connections_established')
+        self.consecutive_timeouts[address] = 0
+        self.reconnect.note_connected(address)
+
+        # Last line of the startup profile: boot to first usable device
+        if not self._first_connection_logged:
+            self._first_connection_logged = True
+            first_s = time.monotonic() - self._started_at
+            metrics.set_gauge('startup_first_connect_s', round(first_s, 1))
+            logger.info(f"Startup: first connection established "
+                        f"{first_s:.1f}s after boot "
+                        f"(transport open {metrics.get('transport_open_ms')}ms)")
+
+        # Wait indefinitely for disconnection (no timeout here)
+        await session.wait_for_disconnection()
+        logger.info(f"[{address}] wait_for_disconnection() returned")
+
+    async def reload_config(self):
+        """Hot-reload configuration (SIGHUP) without reconnecting.
+
+        config.ini and button_config.json changes apply to the live
+        sessions in place - the compiled dispatch tables swap
+        atomically - so remapping a button no longer costs the ~8s
+        transport/pair/discover cycle of a restart. Only a change to
+        devices.conf touches BLE state, and only for the addresses
+        that actually changed.
+        """
+        logger.info("Reloading configuration (SIGHUP)")
+        config.reload()
+
+        old = set(self.device_addresses)
+        addresses = config.get_device_addresses()
+        if addresses:
+            self.device_addresses = addresses
+        else:
+            logger.warning("devices.conf is now empty - keeping current devices")
+        new = set(self.device_addresses)
+
+        if self.host:
+            for session in self.host.sessions.values():
+                session.button_handler.reload()
+
+        for address in old - new:
+            logger.info(f"[{address}] Removed from devices.conf - disconnecting")
+            task = self._loop_tasks.pop(address, None)
+            if task and not task.done():
+                task.cancel()
+            if self.host:
+                try:
+                    await self.host.session(address).cleanup()
+                except Exception as e:
+                    logger.warning(f"[{address}] Cleanup on removal failed: {e}")
+
+        for address in new - old:
+            logger.info(f"[{address}] Added to devices.conf - connecting")
+            self.consecutive_timeouts.pop(address, None)
+            self._loop_tasks[address] = asyncio.create_task(
+                self._device_loop(address))
+
+        logger.info("Configuration reloaded")
+
+    async def _watch_for_resume(self):
+        """Detect Kindle resume and abort the stale connection cycles.
+
+        CLOCK_MONOTONIC halts while the Kindle is suspended but the RTC
+        keeps running, so after a resume the wall clock has jumped ahead
+        of the monotonic clock since the last sample. On detection every
+        in-flight cycle is cancelled immediately - the BT controller
+        always needs a fresh HCI reset after resume, so there is no point
+        letting the old cycles run into their 90s timeout.
+        """
+        interval = config.resume_poll_interval
+        last_wall = time.time()
+        last_mono = time.monotonic()
+
+        while self.running:
+            await asyncio.sleep(interval)
+
+            wall = time.time()
+            mono = time.monotonic()
+            gap = (wall - last_wall) - (mono - last_mono)
+            last_wall, last_mono = wall, mono
+
+            if gap > config.resume_gap_threshold:
+                logger.warning(f"Resume detected (clock gap {gap:.1f}s)")
+                metrics.incr('resume_events')
+                self._resume_generation += 1
+                for task in list(self._cycle_tasks.values()):
+                    if task and not task.done():
+                        task.cancel()
+
+    def _collect_cycle_garbage(self):
+        """Gated gc.collect() at a connection-cycle boundary.
+
+        Rate-limited so aggressive 1s reconnect retries don't collect
+        every cycle. After the pass the host's retired-Device weakrefs
+        are swept: anything still alive is a real leak, warned about
+        and exported as the leaked_devices gauge.
+        """
+        now = time.monotonic()
+        if now - self._last_gc < _GC_MIN_INTERVAL:
+            return
+        self._last_gc = now
+
+        started = time.monotonic()
+        freed = gc.collect()
+        elapsed_ms = (time.monotonic() - started) * 1000.0
+
+        leaked = self.host.sweep_retired() if self.host else 0
+        metrics.set_gauge('leaked_devices', leaked)
+        logger.debug(f"GC at cycle boundary: {freed} objects freed "
+                     f"in {elapsed_ms:.0f}ms")
+
+    async def _sample_rss(self):
+        """Periodic RSS sampler (logged + rss_kb gauge on the metrics
+        endpoint).
+
+        One /proc read every rss_sample_interval seconds; the first
+        sample is kept as the baseline so every later line carries the
+        drift since startup - the number a 30-day soak is judged on.
+        """
+        interval = max(config.rss_sample_interval, 10)
+
+        while self.running:
+            rss_kb = _read_rss_kb()
+            if rss_kb:
+                if not self._rss_baseline_kb:
+                    self._rss_baseline_kb = rss_kb
+                    metrics.set_gauge('rss_baseline_kb', rss_kb)
+                metrics.set_gauge('rss_kb', rss_kb)
+                delta = rss_kb - self._rss_baseline_kb
+                logger.info(f"RSS: {rss_kb} kB ({delta:+d} kB since startup)")
+            await asyncio.sleep(interval)
+
+    async def _watch_loop_stalls(self):
+        """Measure event-loop scheduling latency and log stalls.
+
+        Sleeps for a fine interval and measures the overshoot: when the
+        loop is blocked (a sync json.dump to flash, a burst of log
+        writes), the sleep returns late by exactly the blocked time. On
+        a stall past the threshold the duration and the pending tasks'
+        stacks are logged. A companion sampler thread watches the same
+        heartbeat and grabs the main thread's stack *while* it is still
+        blocked, so the log names the actual blocking call, not just the
+        aftermath.
+        """
+        interval = config.stall_poll_ms / 1000.0
+        threshold = config.stall_threshold_ms / 1000.0
+
+        self._loop_heartbeat = time.monotonic()
+        sampler = threading.Thread(
+            target=self._stall_sampler,
+            args=(interval, threshold),
+            name='loop-watchdog',
+            daemon=True
+        )
+        sampler.start()
+
+        while self.running:
+            before = time.monotonic()
+            await asyncio.sleep(interval)
+            now = time.monotonic()
+            self._loop_heartbeat = now
+
+            lag = now - before - interval
+            if lag >= threshold:
+                metrics.incr('loop_stalls')
+                logger.warning(f"Event loop stalled for {lag * 1000:.0f}ms "
+                               f"(threshold {config.stall_threshold_ms}ms)")
+                self._log_task_stacks()
+
+    def _stall_sampler(self, interval: float, threshold: float):
+        """Sampler thread: capture the main thread's stack mid-stall.
+
+        Runs off the event loop, so it still executes while the loop is
+        blocked. One capture per stall; re-arms once the heartbeat
+        advances again.
+        """
+        main_id = threading.main_thread().ident
+        reported = False
+
+        while self.running:
+            time.sleep(interval)
+            stalled = (time.monotonic() - self._loop_heartbeat) > (interval + threshold)
+
+            if stalled and not reported:
+                frame = sys._current_frames().get(main_id)
+                if frame is not None:
+                    stack = ''.join(traceback.format_stack(frame))
+                    logger.warning(f"Event loop blocked in:\n{stack.rstrip()}")
+                reported = True
+            elif not stalled:
+                reported = False
+
+    def _log_task_stacks(self):
+        """Log one-line stack summaries of all pending tasks."""
+        current = asyncio.current_task()
+        for task in asyncio.all_tasks():
+            if task is current or task.done():
+                continue
+            frames = [f"{f.f_code.co_filename.rsplit('/', 1)[-1]}:"
+                      f"{f.f_lineno} {f.f_code.co_name}"
+                      for f in task.get_stack(limit=5)]
+            if frames:
+                logger.warning(f"  task {task.get_name()}: "
+                               f"{' <- '.join(reversed(frames))}")
+
+    def _metrics_snapshot(self) -> dict:
+        """Daemon/session state merged into each served metrics snapshot.
+
+        Pure in-memory reads, so serving a poll never touches the flash
+        or blocks the loop.
+        """
+        sessions = {}
+        if self.host:
+            for address, session in self.host.sessions.items():
+                sessions[address] = {
+                    'connected': session.connection is not None,
+                    'device_name': session.device_name,
+                    'rssi': session.last_rssi,
+                    'connection_profile': session._conn_profile,
+                    'restored_from_cache': session._restored_from_cache,
+                    'next_reconnect_delay': self.reconnect.next_delay(address),
+                }
+
+        return {
+            'daemon': {
+                'version': __version__,
+                'running': self.running,
+                'devices': list(self.device_addresses),
+                'consecutive_timeouts': dict(self.consecutive_timeouts),
+            },
+            'sessions': sessions,
+        }
+
+    async def _resume_reset(self):
+        """Reinitialize the BT hardware once per resume event.
+
+        All device loops land here after the watcher cancels their
+        cycles; the lock plus generation check make sure only the first
+        one actually closes the transport.
+        """
+        async with self._reset_lock:
+            if self._reset_generation < self._resume_generation:
+                self._reset_generation = self._resume_generation
+                logger.warning("Reinitializing BT hardware after resume")
+                await self._force_cleanup()
+                flush_logs()
 
     async def _force_cleanup(self):
-        """Force cleanup of host and transport with timeout protection."""
+        """Force cleanup of sessions and transport with timeout protection."""
         if not self.host:
             return
 
         logger.info("Force cleanup: closing transport...")
 
         try:
-            await asyncio.wait_for(self.host.cleanup(), timeout=5.0)
+            await asyncio.wait_for(
+                self.host.cleanup(close_transport=True), timeout=5.0
+            )
             logger.info("Force cleanup: graceful cleanup succeeded")
         except asyncio.TimeoutError:
             logger.warning("Force cleanup: graceful cleanup timed out, forcing close")
@@ -171,7 +606,6 @@ class BLEHIDDaemon:
         except Exception as e:
             logger.warning(f"Force cleanup: error during cleanup: {e}")
 
-        self.host = None
         logger.info("Force cleanup: complete")
 
     async def stop(self):
@@ -179,19 +613,30 @@ class BLEHIDDaemon:
         logger.info("Stopping daemon...")
         self.running = False
 
+        for task in list(self._cycle_tasks.values()):
+            if task and not task.done():
+                task.cancel()
+
         if self.host:
             try:
-                await asyncio.wait_for(self.host.cleanup(), timeout=10.0)
+                # Shutdown always releases the transport
+                await asyncio.wait_for(
+                    self.host.cleanup(close_transport=True), timeout=10.0
+                )
             except asyncio.TimeoutError:
                 logger.warning("Stop: cleanup timed out")
             except Exception as e:
                 logger.error(f"Error cleaning up host: {e}")
 
+        flush_logs()
+
 
 async def main():
     """Entry point."""
     # Configure logging for daemon mode
-    setup_daemon_logging(config.log_file)
+    setup_daemon_logging(config.log_file, buffered=config.log_buffered,
+                         max_bytes=config.log_max_kb * 1024,
+                         backup_count=config.log_backup_count)
 
     daemon = BLEHIDDaemon()
     shutdown_event = asyncio.Event()
@@ -205,6 +650,23 @@ async def main():
     for sig in (signal.SIGTERM, signal.SIGINT):
         loop.add_signal_handler(sig, signal_handler)
 
+    # SIGUSR1 dumps latency histograms and counters into the daemon log
+    loop.add_signal_handler(
+        signal.SIGUSR1, lambda: metrics.log_summary(logger)
+    )
+
+    # SIGUSR2 dumps the HCI trace ring to a btsnoop file (`just hci-trace`)
+    loop.add_signal_handler(
+        signal.SIGUSR2,
+        lambda: daemon.host and daemon.host.dump_hci_trace('SIGUSR2')
+    )
+
+    # SIGHUP hot-reloads config.ini / button_config.json / devices.conf
+    # without tearing down healthy connections (`just reload`)
+    loop.add_signal_handler(
+        signal.SIGHUP, lambda: asyncio.create_task(daemon.reload_config())
+    )
+
     # Run daemon in a task
     daemon_task = asyncio.create_task(daemon.run())
 
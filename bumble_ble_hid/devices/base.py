@@ -9,7 +9,7 @@ Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
 from abc import ABC, abstractmethod
-from typing import Optional, Tuple
+from typing import Dict, Optional, Tuple
 
 __all__ = ['ButtonMapper', 'ButtonResult']
 
@@ -54,6 +54,18 @@ class ButtonMapper(ABC):
         """Human-readable name of the device this mapper supports."""
         pass
 
+    def direct_mappings(self) -> Dict[int, Tuple[int, str]]:
+        """Movement-independent button-state mappings.
+
+        States listed here decode the same way regardless of X/Y data,
+        so the button handler can precompile them into a flat dispatch
+        table and skip map() entirely on the hot path.
+
+        Returns:
+            Mapping of raw button state to (button_code, button_name)
+        """
+        return {}
+
     def is_release_event(self, button_state: int) -> bool:
         """Check if this is a button release event.
 
@@ -54,6 +54,10 @@ class BLEM3Mapper(ButtonMapper):
     def device_name(self) -> str:
         return "BLE-M3"
 
+    def direct_mappings(self):
+        """Expose the movement-independent states for table compilation."""
+        return dict(_DIRECT_MAPPINGS)
+
     def map(self, button_state: int, x_movement: int = 0, y_movement: int = 0) -> ButtonResult:
         """Map BLE-M3 button state to standardized button code.
 
@@ -8,13 +8,29 @@ reconnection to BLE HID devices.
 Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
+import asyncio
+import hashlib
 import json
 import logging
 import os
 from typing import Optional, Dict, List
 
+from metrics import metrics
+
 logger = logging.getLogger(__name__)
 
+# Cache schema versions:
+#   1 (implicit) - report map + partial characteristic data; discovery
+#                  still runs on every reconnect
+#   2            - complete attribute database (service handle range,
+#                  characteristics, report references, HID info) allowing
+#                  a reconnect with zero discovery round trips
+SCHEMA_VERSION = 2
+
+# Keys that must be present for a zero-discovery reconnect
+_COMPLETE_KEYS = ('report_map', 'characteristics', 'service_handles',
+                  'report_refs')
+
 
 class GATTCache:
     """Manages caching of GATT characteristics for fast reconnection"""
@@ -51,6 +67,7 @@ class GATTCache:
         """
         cache_path = self._get_cache_path(address)
         if not os.path.exists(cache_path):
+            metrics.incr('gatt_cache_misses')
             return None
 
         try:
@@ -60,13 +77,16 @@ class GATTCache:
             # Validate cache structure
             if 'report_map' not in cache:
                 logger.warning(f"Invalid cache structure for {address}")
+                metrics.incr('gatt_cache_misses')
                 return None
 
             logger.info(f"Loaded GATT cache for {address}")
+            metrics.incr('gatt_cache_hits')
             return cache
 
         except Exception as e:
             logger.warning(f"Failed to load cache for {address}: {e}")
+            metrics.incr('gatt_cache_misses')
             return None
 
     def save(self, address: str, cache_data: Dict) -> bool:
@@ -80,6 +100,9 @@ class GATTCache:
             True if saved successfully, False otherwise
         """
         try:
+            cache_data['schema'] = SCHEMA_VERSION
+            cache_data['db_hash'] = self.compute_db_hash(cache_data)
+
             cache_path = self._get_cache_path(address)
             with open(cache_path, 'w') as f:
                 json.dump(cache_data, f, indent=2)
@@ -91,6 +114,102 @@ class GATTCache:
             logger.warning(f"Failed to save cache for {address}: {e}")
             return False
 
+    # Executor-backed variants for callers running on the event loop.
+    # A JSON write to the slow eMMC can stall the loop long enough to
+    # delay ATT responses mid-connection, so the async paths in host.py
+    # must use these instead of the synchronous methods above.
+
+    async def load_async(self, address: str) -> Optional[Dict]:
+        """load() off the event loop (thread executor)."""
+        loop = asyncio.get_event_loop()
+        return await loop.run_in_executor(None, self.load, address)
+
+    async def save_async(self, address: str, cache_data: Dict) -> bool:
+        """save() off the event loop (thread executor)."""
+        loop = asyncio.get_event_loop()
+        return await loop.run_in_executor(None, self.save, address, cache_data)
+
+    async def update_async(self, address: str, updates: Dict) -> bool:
+        """update() off the event loop (thread executor)."""
+        loop = asyncio.get_event_loop()
+        return await loop.run_in_executor(None, self.update, address, updates)
+
+    @staticmethod
+    def compute_db_hash(cache_data: Dict) -> str:
+        """Hash the attribute database portion of a cache entry.
+
+        Lets a later full discovery detect that the remote's attribute
+        table changed (firmware update, re-provisioned device) so stale
+        handles aren't silently reused.
+
+        Args:
+            cache_data: Cache dictionary
+
+        Returns:
+            Hex digest over the structural attribute data
+        """
+        db = {
+            key: cache_data.get(key)
+            for key in ('service_handles', 'characteristics',
+                        'report_refs', 'report_map')
+        }
+        blob = json.dumps(db, sort_keys=True).encode('utf-8')
+        return hashlib.sha1(blob).hexdigest()
+
+    @staticmethod
+    def is_complete(cache: Dict) -> bool:
+        """Check whether a cache entry supports zero-discovery reconnect.
+
+        Args:
+            cache: Cache dictionary returned by load()
+
+        Returns:
+            True if the entry holds the complete attribute database
+        """
+        if cache.get('schema', 1) < SCHEMA_VERSION:
+            return False
+        return all(cache.get(key) for key in _COMPLETE_KEYS)
+
+    def is_bonded(self, address: str) -> bool:
+        """Check the per-device "bonded and verified" flag.
+
+        Set after a reconnect cycle completes with stored keys, it lets
+        the next connection start encryption directly - overlapped with
+        cache-backed setup - instead of running the serial keystore
+        probe in pair() first.
+
+        Args:
+            address: BLE device address
+
+        Returns:
+            True if the last cycle verified the stored bonding keys
+        """
+        cache = self.load(address)
+        return bool(cache and cache.get('bonded'))
+
+    def set_bonded(self, address: str, bonded: bool) -> bool:
+        """Record whether the stored bonding keys are known-good.
+
+        Args:
+            address: BLE device address
+            bonded: True after a successful encrypted setup, False when
+                the remote rejects the stored keys
+
+        Returns:
+            True if the flag was persisted
+        """
+        return self.update(address, {'bonded': bonded})
+
+    async def is_bonded_async(self, address: str) -> bool:
+        """is_bonded() off the event loop (thread executor)."""
+        loop = asyncio.get_event_loop()
+        return await loop.run_in_executor(None, self.is_bonded, address)
+
+    async def set_bonded_async(self, address: str, bonded: bool) -> bool:
+        """set_bonded() off the event loop (thread executor)."""
+        loop = asyncio.get_event_loop()
+        return await loop.run_in_executor(None, self.set_bonded, address, bonded)
+
     def update(self, address: str, updates: Dict) -> bool:
         """Update existing cache with new data
 
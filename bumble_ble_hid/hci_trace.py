@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+HCI Trace Ring
+
+In-memory capture of HCI traffic between the transport and the Bumble
+Device, dumped to a btsnoop file on demand. btmon doesn't exist on the
+Kindle, so when a reconnect occasionally stalls in the field the log
+lines are all we get; the ring keeps the last few thousand packets
+(timestamped, a few hundred KB at most) at near-zero steady-state cost
+and turns "sometimes reconnect takes 60s" into one SIGUSR2 away from a
+capture that opens in Wireshark.
+
+The tracer sits between transport.source/sink and the Device as two
+thin delegating wrappers - the same interposition Bumble itself uses
+for transport bridging - so nothing in the HCI path changes when
+tracing is disabled except two attribute lookups.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import collections
+import logging
+import struct
+import time
+
+from config import config
+
+__all__ = ['HCITraceRing', 'TracingSource', 'TracingSink', 'wrap_transport']
+
+logger = logging.getLogger(__name__)
+
+# Packet directions (btsnoop flag bit 0)
+DIR_SENT = 0      # host -> controller
+DIR_RECEIVED = 1  # controller -> host
+
+# H4 packet type indicators (first byte of every transport packet)
+_H4_COMMAND = 0x01
+_H4_EVENT = 0x04
+
+# btsnoop file header: magic, version 1, datalink 1002 (HCI UART / H4)
+_BTSNOOP_HEADER = b'btsnoop\x00' + struct.pack('>II', 1, 1002)
+
+# Microseconds between the btsnoop epoch (year 0 AD) and the Unix epoch
+_BTSNOOP_EPOCH_DELTA = 0x00DCDDB30F2F8000
+
+
+class HCITraceRing:
+    """Fixed-size ring of timestamped HCI packets.
+
+    record() is the hot path: one deque append of an already-materialized
+    bytes object, no formatting, no I/O. The deque's maxlen evicts the
+    oldest packet automatically, so steady-state memory is capped.
+    """
+
+    def __init__(self, max_packets: int = None):
+        """Initialize the ring.
+
+        Args:
+            max_packets: Ring capacity (default: config.hci_trace_packets)
+        """
+        self._ring = collections.deque(
+            maxlen=max_packets or config.hci_trace_packets)
+
+    def record(self, direction: int, packet: bytes):
+        """Append one packet (called per HCI packet in both directions)."""
+        self._ring.append((time.time(), direction, bytes(packet)))
+
+    def clear(self):
+        """Drop all captured packets."""
+        self._ring.clear()
+
+    def __len__(self):
+        return len(self._ring)
+
+    def dump(self, path: str) -> bool:
+        """Write the captured packets as a btsnoop file.
+
+        Synchronous file I/O - call off the event loop (the daemon goes
+        through an executor). The ring keeps capturing while the
+        snapshot is written; the dump covers the packets present at
+        call time.
+
+        Args:
+            path: Output file (overwritten - one bounded file on flash,
+                not an ever-growing collection)
+
+        Returns:
+            True if the file was written
+        """
+        packets = list(self._ring)
+        try:
+            with open(path, 'wb') as f:
+                f.write(_BTSNOOP_HEADER)
+                for wall_ts, direction, packet in packets:
+                    flags = direction
+                    if packet and packet[0] in (_H4_COMMAND, _H4_EVENT):
+                        flags |= 0x02
+                    timestamp = int(wall_ts * 1e6) + _BTSNOOP_EPOCH_DELTA
+                    f.write(struct.pack('>IIIIq', len(packet), len(packet),
+                                        flags, 0, timestamp))
+                    f.write(packet)
+            logger.info(f"Dumped {len(packets)} HCI packets to {path}")
+            return True
+        except OSError as e:
+            logger.warning(f"Failed to dump HCI trace: {e}")
+            return False
+
+
+class TracingSource:
+    """Transport source wrapper recording controller->host packets.
+
+    The Device registers itself as the packet sink; the wrapper slots
+    into that registration and forwards every packet after recording
+    it. Everything else delegates to the real source.
+    """
+
+    def __init__(self, source, ring: HCITraceRing):
+        self._source = source
+        self._ring = ring
+        self._packet_sink = None
+
+    def set_packet_sink(self, sink):
+        self._packet_sink = sink
+        self._source.set_packet_sink(self)
+
+    def on_packet(self, packet):
+        self._ring.record(DIR_RECEIVED, packet)
+        if self._packet_sink:
+            self._packet_sink.on_packet(packet)
+
+    def __getattr__(self, name):
+        return getattr(self._source, name)
+
+
+class TracingSink:
+    """Transport sink wrapper recording host->controller packets."""
+
+    def __init__(self, sink, ring: HCITraceRing):
+        self._sink = sink
+        self._ring = ring
+
+    def on_packet(self, packet):
+        self._ring.record(DIR_SENT, packet)
+        self._sink.on_packet(packet)
+
+    def __getattr__(self, name):
+        return getattr(self._sink, name)
+
+
+def wrap_transport(transport, ring: HCITraceRing):
+    """Wrap a transport's endpoints with the tracer.
+
+    Args:
+        transport: Open Bumble transport (source/sink attributes)
+        ring: Ring the wrappers record into
+
+    Returns:
+        (source, sink) to hand to Device.with_hci()
+    """
+    return (TracingSource(transport.source, ring),
+            TracingSink(transport.sink, ring))
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+HID Report Map Decoder
+
+Compiles a HID report descriptor (the Report Map characteristic the host
+already reads and caches) into per-report-ID field layouts: precomputed
+byte offsets for the button bitfield and the X/Y axes. Decoding a report
+then becomes a few fixed index operations instead of the hardcoded
+byte-1/2/3 guesswork that only fits the BLE-M3.
+
+The compiled layout is plain-JSON serializable so it can live in the
+GATT cache next to the report map hex, letting reconnects skip parsing
+entirely.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import logging
+from typing import Dict, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+__all__ = ['ReportDecoder']
+
+# Usage pages / usages we care about (USB HID Usage Tables)
+USAGE_PAGE_GENERIC_DESKTOP = 0x01
+USAGE_PAGE_BUTTON = 0x09
+USAGE_X = 0x30
+USAGE_Y = 0x31
+
+# Item prefixes (tag | type, size bits masked off)
+_ITEM_USAGE_PAGE = 0x04
+_ITEM_USAGE = 0x08
+_ITEM_USAGE_MINIMUM = 0x18
+_ITEM_USAGE_MAXIMUM = 0x28
+_ITEM_REPORT_SIZE = 0x74
+_ITEM_REPORT_ID = 0x84
+_ITEM_REPORT_COUNT = 0x94
+_ITEM_INPUT = 0x80
+_ITEM_OUTPUT = 0x90
+_ITEM_FEATURE = 0xB0
+
+_INPUT_CONSTANT = 0x01  # Input item flag: constant (padding)
+
+
+def _items(report_map: bytes):
+    """Iterate (prefix, data) pairs over the descriptor's short items."""
+    i = 0
+    length = len(report_map)
+    while i < length:
+        prefix = report_map[i]
+        i += 1
+
+        if prefix == 0xFE:  # long item: skip (never seen on HID remotes)
+            if i < length:
+                i += 2 + report_map[i]
+            continue
+
+        size = prefix & 0x03
+        if size == 3:
+            size = 4
+        data = int.from_bytes(report_map[i:i + size], 'little')
+        i += size
+        yield (prefix & 0xFC, data)
+
+
+class ReportDecoder:
+    """Specialized report decoder compiled from a report descriptor.
+
+    Each layout maps a report ID to the byte offsets of the button
+    bitfield and the X/Y axis fields (offsets are relative to the report
+    payload, excluding any report ID prefix byte).
+    """
+
+    def __init__(self, layouts: Dict[int, Dict]):
+        self._layouts = layouts
+
+    @classmethod
+    def from_report_map(cls, report_map: bytes) -> 'ReportDecoder':
+        """Compile layouts by walking the descriptor's input items.
+
+        Raises:
+            ValueError: If no input fields could be located
+        """
+        layouts: Dict[int, Dict] = {}
+        usage_page = 0
+        report_size = 0
+        report_count = 0
+        report_id = 0
+        usages = []
+        usage_min = None
+        usage_max = None
+
+        def layout(rid: int) -> Dict:
+            return layouts.setdefault(
+                rid, {'buttons': None, 'x': None, 'y': None, 'bits': 0}
+            )
+
+        for prefix, data in _items(report_map):
+            if prefix == _ITEM_USAGE_PAGE:
+                usage_page = data
+            elif prefix == _ITEM_REPORT_SIZE:
+                report_size = data
+            elif prefix == _ITEM_REPORT_COUNT:
+                report_count = data
+            elif prefix == _ITEM_REPORT_ID:
+                report_id = data
+            elif prefix == _ITEM_USAGE:
+                usages.append(data)
+            elif prefix == _ITEM_USAGE_MINIMUM:
+                usage_min = data
+            elif prefix == _ITEM_USAGE_MAXIMUM:
+                usage_max = data
+
+            elif prefix == _ITEM_INPUT:
+                lay = layout(report_id)
+                bit = lay['bits']
+
+                if not data & _INPUT_CONSTANT:
+                    if usage_page == USAGE_PAGE_BUTTON:
+                        if lay['buttons'] is None:
+                            lay['buttons'] = bit // 8
+                    elif usage_page == USAGE_PAGE_GENERIC_DESKTOP:
+                        field_usages = usages
+                        if not field_usages and usage_min is not None:
+                            field_usages = list(
+                                range(usage_min, (usage_max or usage_min) + 1)
+                            )
+                        for idx, usage in enumerate(field_usages[:report_count]):
+                            offset = (bit + idx * report_size) // 8
+                            if usage == USAGE_X and lay['x'] is None:
+                                lay['x'] = offset
+                            elif usage == USAGE_Y and lay['y'] is None:
+                                lay['y'] = offset
+
+                lay['bits'] = bit + report_size * report_count
+                usages = []
+                usage_min = usage_max = None
+
+            elif prefix in (_ITEM_OUTPUT, _ITEM_FEATURE):
+                # Output/feature fields don't consume input report bits
+                usages = []
+                usage_min = usage_max = None
+
+        # Finalize byte sizes and drop layouts with no input fields
+        compiled = {}
+        for rid, lay in layouts.items():
+            if lay['bits'] == 0:
+                continue
+            lay['size'] = (lay['bits'] + 7) // 8
+            del lay['bits']
+            compiled[rid] = lay
+
+        if not any(lay['buttons'] is not None for lay in compiled.values()):
+            raise ValueError("No button input fields in report map")
+
+        return cls(compiled)
+
+    def decode(self, report_data: bytes) -> Optional[Tuple[int, int, int]]:
+        """Decode a raw report into (button_state, x, y).
+
+        HID-over-GATT notifications normally omit the report ID byte, but
+        the BLE-M3 prefixes one anyway; the expected payload size from
+        the descriptor disambiguates.
+
+        Args:
+            report_data: Raw notification bytes
+
+        Returns:
+            (button_state, x_movement, y_movement) or None if the report
+            matches no compiled layout
+        """
+        n = len(report_data)
+
+        for rid, lay in self._layouts.items():
+            size = lay['size']
+            if n == size:
+                base = 0
+            elif n == size + 1 and (rid == 0 or report_data[0] == rid):
+                base = 1  # report ID prefix present
+            else:
+                continue
+
+            def field(offset):
+                if offset is None:
+                    return 0
+                index = base + offset
+                return report_data[index] if index < n else 0
+
+            return (field(lay['buttons']), field(lay['x']), field(lay['y']))
+
+        return None
+
+    def button_byte_index(self, report_data: bytes) -> Optional[int]:
+        """Index of the button byte within a raw notification.
+
+        Used by the button handler's coalescing front-end, which needs
+        the button byte before deciding whether a full decode is worth
+        the work. Same layout matching as decode(), without touching
+        the axis fields.
+
+        Returns:
+            Index into report_data, or None if no layout matches or the
+            matching layout has no button field
+        """
+        n = len(report_data)
+        for rid, lay in self._layouts.items():
+            size = lay['size']
+            if n == size:
+                base = 0
+            elif n == size + 1 and (rid == 0 or report_data[0] == rid):
+                base = 1
+            else:
+                continue
+            if lay['buttons'] is None:
+                return None
+            index = base + lay['buttons']
+            return index if index < n else None
+        return None
+
+    def to_cache(self) -> Dict:
+        """Serialize the compiled layouts for the GATT cache."""
+        return {
+            'layouts': {str(rid): lay for rid, lay in self._layouts.items()}
+        }
+
+    @classmethod
+    def from_cache(cls, data: Dict) -> 'ReportDecoder':
+        """Restore a decoder previously serialized with to_cache()."""
+        return cls({int(rid): lay for rid, lay in data['layouts'].items()})
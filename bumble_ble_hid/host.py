@@ -5,224 +5,305 @@ BLE HID Host
 Core BLE stack implementation using Google Bumble.
 Handles connection, pairing, GATT discovery, and HID report subscription.
 
+One BLEHIDHost owns the HCI transport and the Bumble Device; per-peer
+connection state lives in HIDSession so several HID devices (page
+turner + foot pedal) can multiplex over the single radio and event loop.
+
 Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
-__version__ = "2.1.0"  # Split connection setup from idle waiting
+__version__ = "2.4.0"  # Multi-device sessions over one shared transport
 
 import asyncio
 import logging
-from typing import Optional
-
-from bumble.device import Device, Peer
-from bumble.hci import Address, HCI_Reset_Command
-from bumble.gatt import (
-    GATT_GENERIC_ACCESS_SERVICE,
-    GATT_DEVICE_NAME_CHARACTERISTIC,
-    Characteristic,
-    Descriptor,
-)
-from bumble.transport import open_transport
-from bumble.core import UUID, AdvertisingData
+import time
+import weakref
+from typing import Dict, Optional
 
 from config import config
 from logging_utils import log, color
+from metrics import metrics
 from gatt_cache import GATTCache
+from hci_trace import HCITraceRing, wrap_transport
+from hid_decoder import ReportDecoder
 from button_handler import ButtonHandler
-from pairing import create_pairing_config, create_keystore
-
-__all__ = ['BLEHIDHost', '__version__']
 
-# BLE HID Service UUIDs (Bluetooth SIG)
-GATT_HID_SERVICE = UUID.from_16_bits(0x1812)
-GATT_HID_INFORMATION_CHARACTERISTIC = UUID.from_16_bits(0x2A4A)
-GATT_HID_REPORT_MAP_CHARACTERISTIC = UUID.from_16_bits(0x2A4B)
-GATT_HID_REPORT_CHARACTERISTIC = UUID.from_16_bits(0x2A4D)
-GATT_REPORT_REFERENCE_DESCRIPTOR = UUID.from_16_bits(0x2908)
-GATT_CCCD = UUID.from_16_bits(0x2902)
+__all__ = ['BLEHIDHost', 'HIDSession', '__version__']
 
 # HID Report Types
 HID_REPORT_TYPE_INPUT = 1
 
-
-class BLEHIDHost:
-    """BLE HID Host that connects to HID devices and handles input.
-
-    This class manages the BLE connection lifecycle:
-    1. Transport initialization and HCI reset
-    2. Device scanning (optional)
-    3. Connection establishment
-    4. SMP pairing with key persistence
-    5. GATT service discovery (with caching)
-    6. HID report subscription
-    7. Button event processing
+# The Bumble stack (and the BLE HID UUID constants derived from its UUID
+# class) is imported lazily by _import_bumble(): loading bumble.device
+# and friends costs seconds on the Kindle and dominated daemon cold
+# start, so it is deferred until a BLEHIDHost is actually constructed -
+# after config and devices.conf have been read and validated.
+_bumble_loaded = False
+
+
+def _import_bumble():
+    """Import the Bumble stack on first use (idempotent)."""
+    global _bumble_loaded
+    if _bumble_loaded:
+        return
+
+    started = time.monotonic()
+
+    from bumble.device import Device, Peer
+    from bumble import hci as _hci
+    from bumble.hci import (
+        Address,
+        HCI_Reset_Command,
+        HCI_Read_Local_Version_Information_Command,
+        HCI_LE_Create_Connection_Command,
+        HCI_LE_Create_Connection_Cancel_Command,
+    )
+    from bumble.gatt import (
+        GATT_GENERIC_ACCESS_SERVICE,
+        GATT_DEVICE_NAME_CHARACTERISTIC,
+        Characteristic,
+        Descriptor,
+        Service,
+    )
+    from bumble.transport import open_transport
+    from bumble.core import UUID, AdvertisingData
+    from pairing import create_pairing_config, create_keystore
+
+    globals().update(
+        Device=Device,
+        Peer=Peer,
+        Address=Address,
+        HCI_Reset_Command=HCI_Reset_Command,
+        HCI_Read_Local_Version_Information_Command=(
+            HCI_Read_Local_Version_Information_Command),
+        HCI_LE_Create_Connection_Command=HCI_LE_Create_Connection_Command,
+        HCI_LE_Create_Connection_Cancel_Command=(
+            HCI_LE_Create_Connection_Cancel_Command),
+        # Renamed from "white list" in newer Bluetooth specs; accept
+        # whichever name this Bumble version exports
+        HCI_LE_Clear_Filter_Accept_List_Command=getattr(
+            _hci, 'HCI_LE_Clear_Filter_Accept_List_Command',
+            getattr(_hci, 'HCI_LE_Clear_White_List_Command', None)),
+        HCI_LE_Add_Device_To_Filter_Accept_List_Command=getattr(
+            _hci, 'HCI_LE_Add_Device_To_Filter_Accept_List_Command',
+            getattr(_hci, 'HCI_LE_Add_Device_To_White_List_Command', None)),
+        GATT_GENERIC_ACCESS_SERVICE=GATT_GENERIC_ACCESS_SERVICE,
+        GATT_DEVICE_NAME_CHARACTERISTIC=GATT_DEVICE_NAME_CHARACTERISTIC,
+        Characteristic=Characteristic,
+        Descriptor=Descriptor,
+        Service=Service,
+        open_transport=open_transport,
+        UUID=UUID,
+        AdvertisingData=AdvertisingData,
+        create_pairing_config=create_pairing_config,
+        create_keystore=create_keystore,
+        # BLE HID Service UUIDs (Bluetooth SIG)
+        GATT_HID_SERVICE=UUID.from_16_bits(0x1812),
+        GATT_HID_INFORMATION_CHARACTERISTIC=UUID.from_16_bits(0x2A4A),
+        GATT_HID_REPORT_MAP_CHARACTERISTIC=UUID.from_16_bits(0x2A4B),
+        GATT_HID_REPORT_CHARACTERISTIC=UUID.from_16_bits(0x2A4D),
+        GATT_REPORT_REFERENCE_DESCRIPTOR=UUID.from_16_bits(0x2908),
+        GATT_CCCD=UUID.from_16_bits(0x2902),
+    )
+
+    _bumble_loaded = True
+    elapsed_ms = (time.monotonic() - started) * 1000.0
+    metrics.set_gauge('startup_import_ms', round(elapsed_ms, 1))
+    log.detail(f"Bumble stack imported in {elapsed_ms:.0f}ms")
+
+
+class HIDSession:
+    """Per-peer connection state multiplexed over the shared host radio.
+
+    Everything that belongs to one remote device lives here: the
+    connection and Peer, the discovered HID reports, the GATT cache
+    entry, the report decoder, and the ButtonHandler that dispatches its
+    presses. The host hands each session the shared Device; sessions
+    never touch the transport.
     """
 
-    def __init__(self, transport_spec: str = None):
-        """Initialize BLE HID Host.
+    def __init__(self, host: 'BLEHIDHost', address: str):
+        """Initialize a session for one remote device.
 
         Args:
-            transport_spec: HCI transport (default: from config)
+            host: Owning BLEHIDHost (shared transport and Device)
+            address: BLE address of the remote device
         """
-        self.transport_spec = transport_spec or config.transport
-        self.device = None
+        self.host = host
+        self.address = address
         self.connection = None
         self.peer = None
-        self.transport = None
 
-        # Components
-        self.gatt_cache = GATTCache(config.cache_dir)
+        # Per-device button dispatch (mapper and decoder differ per peer)
         self.button_handler = ButtonHandler()
-        self.keystore = create_keystore(config.pairing_keys_file)
 
         # State
         self.hid_reports = {}  # report_id -> characteristic
         self.report_map = None
-        self.current_device_address = None
         self.device_name = None
+        self.last_rssi = None  # RSSI of the last advertisement seen from target
+        self.last_adv_at = 0.0  # Monotonic time of that advertisement
         self.disconnection_event = None  # Set when waiting for disconnection
+        self._restored_from_cache = False  # Attribute DB rebuilt without discovery
+        self._service_handles = None  # HID service handle range (for cache v2)
+        self._hid_info_hex = None  # Raw HID Information value (for cache v2)
+
+        # Adaptive connection-parameter profile ('fast' while input is
+        # arriving, 'power' when idle)
+        self._conn_profile = None
+        self._profile_request_pending = False
+        self._last_input_at = 0.0
+        self._idle_revert_task = None
+
+    @property
+    def device(self):
+        """The shared Bumble device (re-created on transport re-init)."""
+        return self.host.device
+
+    @property
+    def gatt_cache(self):
+        """The shared GATT cache manager."""
+        return self.host.gatt_cache
+
+    async def connect(self) -> bool:
+        """Connect to the session's device.
+
+        Uses the controller's filter accept list when enabled (the
+        radio latches the connection itself the moment the remote
+        advertises, zero host CPU during the wait), falling back to a
+        host-driven direct connect.
 
-    async def start(self):
-        """Initialize the Bumble device and BLE stack.
-
-        Raises:
-            asyncio.TimeoutError: If transport or HCI reset times out
+        Returns:
+            True if connected, False on timeout
         """
-        log.info(f"Kindle BLE HID Host v{__version__}")
-        log.info("Opening transport...")
-
-        try:
-            self.transport = await asyncio.wait_for(
-                open_transport(self.transport_spec),
-                timeout=config.transport_timeout
-            )
-        except asyncio.TimeoutError:
-            log.error(f"Transport open timed out after {config.transport_timeout}s")
-            raise
+        log.info(f"Connecting to {self.address}...")
 
-        # Create Bumble device
-        self.device = Device.with_hci(
-            config.device_name,
-            config.device_address,
-            self.transport.source,
-            self.transport.sink
-        )
+        target = Address(self.address)
 
-        # Attach key store and pairing config
-        self.device.keystore = self.keystore
-        self.device.pairing_config_factory = lambda conn: create_pairing_config()
+        if config.auto_connect:
+            try:
+                if not await self._auto_connect(target):
+                    return False
+                return await self._finish_connect()
+            except Exception as e:
+                # Controller or stack without accept-list support:
+                # direct connect still works, just host-driven
+                log.warning(f"Auto-connect unavailable ({e}) - "
+                            "falling back to direct connect")
 
-        # HCI Reset - critical for sleep recovery
-        log.info("Sending HCI Reset...")
         try:
-            await asyncio.wait_for(
-                self.device.host.send_command(HCI_Reset_Command()),
-                timeout=config.hci_reset_timeout
+            self.connection = await asyncio.wait_for(
+                self.device.connect(target),
+                timeout=config.connect_timeout
             )
-            log.success("HCI Reset successful")
         except asyncio.TimeoutError:
-            log.error(f"HCI Reset timed out after {config.hci_reset_timeout}s - "
-                     "BT hardware may be asleep")
-            raise
+            log.warning(f"Connection timeout after {config.connect_timeout}s "
+                       "(device may be off or out of range)")
+            return False
 
-        await self.device.power_on()
-        log.success(f"Device powered on: {self.device.public_address}")
+        return await self._finish_connect()
 
-    async def scan(self, duration: float = 10.0, filter_hid: bool = True):
-        """Scan for BLE devices.
+    async def _auto_connect(self, target) -> bool:
+        """Controller-managed connection via the filter accept list.
+
+        The target address is programmed into the accept list and a
+        create-connection with initiator_filter_policy=1 is issued: the
+        controller scans and completes the connection on its own the
+        instant the remote advertises, so reaction time is one
+        advertising interval and the host spends the wait parked on a
+        future instead of babysitting a direct connect.
 
         Args:
-            duration: Scan duration in seconds
-            filter_hid: If True, only return devices advertising HID service
+            target: Peer Address to latch onto
 
         Returns:
-            List of device dicts with address, name, rssi, is_hid
-        """
-        log.info(f"Scanning for {duration} seconds...")
-
-        devices_found = []
-        seen_addresses = set()
-
-        def on_advertisement(advertisement):
-            addr_str = str(advertisement.address)
-
-            if addr_str in seen_addresses:
-                return
-            seen_addresses.add(addr_str)
+            True with self.connection set, False if the remote never
+            appeared within connect_timeout
 
-            # Extract device name
-            name = 'Unknown'
-            if hasattr(advertisement, 'data') and advertisement.data:
-                name = advertisement.data.get(AdvertisingData.COMPLETE_LOCAL_NAME)
-                if not name:
-                    name = advertisement.data.get(AdvertisingData.SHORTENED_LOCAL_NAME)
-                if not name:
-                    name = 'Unknown'
-                if isinstance(name, bytes):
-                    name = name.decode('utf-8', errors='replace')
-
-            # Check for HID service
-            is_hid = False
-            if hasattr(advertisement, 'data') and advertisement.data:
-                services = advertisement.data.get(
-                    AdvertisingData.COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS
-                )
-                if not services:
-                    services = advertisement.data.get(
-                        AdvertisingData.INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS
-                    )
-                if services:
-                    for service_uuid in services:
-                        if service_uuid == GATT_HID_SERVICE:
-                            is_hid = True
-                            break
-
-            if not filter_hid or is_hid:
-                entry = {
-                    'address': addr_str,
-                    'name': name,
-                    'rssi': advertisement.rssi,
-                    'is_hid': is_hid,
-                }
-                devices_found.append(entry)
-                hid_marker = " [HID]" if is_hid else ""
-                log.detail(f"Found: {entry['name']} ({entry['address']}) "
-                          f"RSSI: {entry['rssi']}{hid_marker}")
+        Raises:
+            Exception: If the stack or controller rejects the accept
+                list commands (caller falls back to direct connect)
+        """
+        if HCI_LE_Add_Device_To_Filter_Accept_List_Command is None:
+            raise Exception("no filter accept list support in this stack")
 
-        self.device.on('advertisement', on_advertisement)
-        await self.device.start_scanning(filter_duplicates=True)
-        await asyncio.sleep(duration)
-        await self.device.stop_scanning()
+        connected = asyncio.get_event_loop().create_future()
 
-        log.success(f"Scan complete. Found {len(devices_found)} devices.")
-        return devices_found
+        def on_connection(connection):
+            if (not connected.done()
+                    and self.host._address_matches(connection.peer_address,
+                                                   self.address)):
+                connected.set_result(connection)
 
-    async def connect(self, address: str) -> bool:
-        """Connect to a BLE device.
+        self.device.on('connection', on_connection)
+        hci_host = self.device.host
+        try:
+            # One bonded target at a time: establishment is serialized
+            # on the host's connect lock, so clear-then-add keeps the
+            # list in a known state without tracking residues
+            await hci_host.send_command(
+                HCI_LE_Clear_Filter_Accept_List_Command())
+            await hci_host.send_command(
+                HCI_LE_Add_Device_To_Filter_Accept_List_Command(
+                    address_type=target.address_type,
+                    address=target,
+                ))
+            await hci_host.send_command(
+                HCI_LE_Create_Connection_Command(
+                    le_scan_interval=0x0060,    # 60ms (0.625ms units)
+                    le_scan_window=0x0030,      # 30ms
+                    initiator_filter_policy=1,  # accept list, not peer fields
+                    peer_address_type=0,
+                    peer_address=Address.ANY,
+                    own_address_type=1,         # random (matches device.connect)
+                    connection_interval_min=int(
+                        config.connection_interval_min / 1.25),
+                    connection_interval_max=int(
+                        config.connection_interval_max / 1.25),
+                    max_latency=config.peripheral_latency,
+                    supervision_timeout=int(config.supervision_timeout / 10),
+                    min_ce_length=0,
+                    max_ce_length=0,
+                ))
+            log.info("Auto-connect armed (controller latches on advertisement)")
 
-        Args:
-            address: BLE device address
+            try:
+                self.connection = await asyncio.wait_for(
+                    connected, timeout=config.connect_timeout)
+            except asyncio.TimeoutError:
+                log.warning(f"Auto-connect timeout after "
+                            f"{config.connect_timeout}s "
+                            "(device may be off or out of range)")
+                try:
+                    await hci_host.send_command(
+                        HCI_LE_Create_Connection_Cancel_Command())
+                except Exception:
+                    pass
+                return False
 
-        Returns:
-            True if connected, False on timeout
-        """
-        log.info(f"Connecting to {address}...")
-        self.current_device_address = address
+            return True
 
-        target = Address(address)
-        try:
-            self.connection = await asyncio.wait_for(
-                self.device.connect(target),
-                timeout=config.connect_timeout
-            )
-        except asyncio.TimeoutError:
-            log.warning(f"Connection timeout after {config.connect_timeout}s "
-                       "(device may be off or out of range)")
-            return False
+        finally:
+            self.device.remove_listener('connection', on_connection)
 
+    async def _finish_connect(self) -> bool:
+        """Shared post-connection setup for both connect paths."""
         self.peer = Peer(self.connection)
         log.success(f"Connected to {self.connection.peer_address}")
 
+        # A completed connection implies the remote was advertising just
+        # now; record it here so presence tracking works on the
+        # auto-connect path too, which skips the host-side scan that
+        # normally stamps these (the reconnect scheduler and the
+        # "setup failed with device in sight" trace dump depend on them)
+        self.last_adv_at = time.monotonic()
+        rssi_reader = getattr(self.device, 'get_connection_rssi', None)
+        if rssi_reader:
+            try:
+                self.last_rssi = await rssi_reader(self.connection)
+            except Exception:
+                pass
+
         # Set up event handlers
         self.connection.on('pairing', self._on_pairing)
         self.connection.on('pairing_failure', self._on_pairing_failure)
@@ -233,32 +314,104 @@ class BLEHIDHost:
         return True
 
     async def _request_connection_parameters(self):
-        """Request power-optimized BLE connection parameters.
+        """Negotiate the initial (power-optimized) connection parameters."""
+        self._conn_profile = None
+        await self._apply_connection_profile(fast=False)
 
-        This negotiates connection interval, peripheral latency, and supervision
-        timeout with the peripheral to reduce battery usage while maintaining
-        responsiveness for HID input.
+    async def _apply_connection_profile(self, fast: bool):
+        """Switch between the fast and power connection-parameter profiles.
+
+        The power profile (long interval, peripheral latency) saves
+        battery but makes worst-case input latency interval*(latency+1);
+        the fast profile (short interval, latency 0) is requested while
+        reports are arriving so page turns land within tens of ms.
+
+        Args:
+            fast: True for the fast profile, False for the power profile
         """
         if not self.connection:
             return
 
+        profile = 'fast' if fast else 'power'
+        if self._conn_profile == profile:
+            return
+
+        if fast:
+            interval_min = config.fast_interval_min
+            interval_max = config.fast_interval_max
+            latency = 0
+        else:
+            interval_min = config.connection_interval_min
+            interval_max = config.connection_interval_max
+            latency = config.peripheral_latency
+
         try:
-            log.info(f"Requesting connection parameters: "
-                    f"interval={config.connection_interval_min}-{config.connection_interval_max}ms, "
-                    f"latency={config.peripheral_latency}, "
+            log.info(f"Requesting {profile} connection parameters: "
+                    f"interval={interval_min}-{interval_max}ms, "
+                    f"latency={latency}, "
                     f"timeout={config.supervision_timeout}ms")
 
             await self.connection.update_parameters(
-                connection_interval_min=config.connection_interval_min,
-                connection_interval_max=config.connection_interval_max,
-                max_latency=config.peripheral_latency,
+                connection_interval_min=interval_min,
+                connection_interval_max=interval_max,
+                max_latency=latency,
                 supervision_timeout=config.supervision_timeout,
             )
-            log.success("Connection parameters updated for power optimization")
+            self._conn_profile = profile
+            log.success(f"Connection parameters updated ({profile} profile)")
 
         except Exception as e:
             # Parameter update is best-effort - don't fail connection if it fails
             log.warning(f"Connection parameter update failed (non-fatal): {e}")
+        finally:
+            self._profile_request_pending = False
+
+    def _note_input_activity(self):
+        """Record input activity and switch to the fast profile.
+
+        Called from the notification path (synchronous), so the actual
+        parameter update is scheduled as a task.
+        """
+        self._last_input_at = time.monotonic()
+
+        if self._conn_profile != 'fast' and not self._profile_request_pending:
+            self._profile_request_pending = True
+            asyncio.ensure_future(self._apply_connection_profile(fast=True))
+
+        if self._idle_revert_task is None or self._idle_revert_task.done():
+            self._idle_revert_task = asyncio.ensure_future(self._revert_when_idle())
+
+    async def _revert_when_idle(self):
+        """Fall back to the power profile once input has gone idle."""
+        while self.connection:
+            idle = time.monotonic() - self._last_input_at
+            remaining = config.fast_idle_timeout - idle
+            if remaining <= 0:
+                break
+            await asyncio.sleep(remaining)
+
+        await self._apply_connection_profile(fast=False)
+
+    async def _fast_encrypt(self) -> bool:
+        """Start encryption directly from stored bonding keys.
+
+        Used on the bonded fast path: the keystore probe and SMP
+        fallback in pair() are skipped entirely, so a reconnect spends
+        one LE Start Encryption exchange on security - and because it
+        runs concurrently with cache-backed setup, that exchange
+        overlaps the CCCD writes instead of preceding them.
+
+        Returns:
+            True if the link was encrypted with the stored keys
+        """
+        try:
+            await self.connection.encrypt()
+            log.success("Bonding restored (fast path)")
+            return True
+        except Exception as e:
+            log.warning(f"Fast-path encryption failed ({e}), "
+                        "falling back to full pairing")
+            return False
 
     async def pair(self) -> bool:
         """Pair with connected device (or restore bonding).
@@ -321,22 +474,31 @@ class BLEHIDHost:
             return False
 
         # Try cache first
-        cache = None
-        if self.current_device_address:
-            cache = self.gatt_cache.load(self.current_device_address)
-            if cache:
-                try:
-                    self.report_map = bytes.fromhex(cache['report_map'])
-                    log.success(f"Using cached report map ({len(self.report_map)} bytes)")
+        cache = await self.gatt_cache.load_async(self.address)
+
+        # Complete v2 entry: rebuild the attribute database locally
+        # and skip every discovery round trip (each costs a full
+        # connection interval)
+        if cache and self.gatt_cache.is_complete(cache):
+            if await self._restore_from_cache(cache):
+                return True
+            log.warning("Cached attribute restore failed, "
+                        "falling back to discovery")
+            cache = None
+
+        if cache:
+            try:
+                self.report_map = bytes.fromhex(cache['report_map'])
+                log.success(f"Using cached report map ({len(self.report_map)} bytes)")
 
-                    if 'device_name' in cache and cache['device_name']:
-                        self.device_name = cache['device_name']
-                        log.success(f"Using cached device name: {self.device_name}")
+                if 'device_name' in cache and cache['device_name']:
+                    self.device_name = cache['device_name']
+                    log.success(f"Using cached device name: {self.device_name}")
 
-                    log.info("Discovering GATT services (using cached data)...")
-                except Exception as e:
-                    logging.warning(f"Cache corrupt, re-discovering: {e}")
-                    cache = None
+                log.info("Discovering GATT services (using cached data)...")
+            except Exception as e:
+                logging.warning(f"Cache corrupt, re-discovering: {e}")
+                cache = None
 
         if not cache:
             log.info("Discovering GATT services...")
@@ -361,149 +523,246 @@ class BLEHIDHost:
         hid_service = hid_services[0]
         log.success(f"Found HID service: {hid_service.uuid}")
 
-        # Load or discover characteristics
-        characteristics_cached = False
-        if cache and 'characteristics' in cache:
-            characteristics_cached = await self._load_cached_characteristics(
-                hid_service, cache
-            )
-
-        if not characteristics_cached:
-            log.info("Discovering characteristics...")
-            await self.peer.discover_characteristics(service=hid_service)
-            log.success(f"Discovered {len(hid_service.characteristics)} characteristics")
+        # Record the service handle range for the v2 cache
+        self._service_handles = {
+            'start': hid_service.handle,
+            'end': hid_service.end_group_handle,
+        }
 
-        # Process characteristics
+        # Reaching this point means the cache entry was absent, partial
+        # (pre-v2), or failed to restore, so always rediscover the
+        # characteristics; _update_cache below writes a complete v2
+        # entry and subsequent reconnects skip discovery entirely
+        if cache and 'characteristics' in cache:
+            log.info("Upgrading cache entry to schema v2 (full rediscovery)")
+        log.info("Discovering characteristics...")
+        await self.peer.discover_characteristics(service=hid_service)
+        log.success(f"Discovered {len(hid_service.characteristics)} characteristics")
+
+        # Process characteristics. The reads are independent, so they are
+        # issued concurrently and pipeline through Bumble's ATT request
+        # queue - setup costs a few connection intervals instead of one
+        # full interval per serial read
         report_refs = {}
         characteristics_to_cache = []
+        read_tasks = []
+        report_chars = []
 
         for char in hid_service.characteristics:
             log.detail(f"Characteristic: {char.uuid}")
 
-            # Collect for caching if not already cached
-            if not characteristics_cached:
-                characteristics_to_cache.append(self._char_to_cache(char))
+            characteristics_to_cache.append(self._char_to_cache(char))
 
             if char.uuid == GATT_HID_INFORMATION_CHARACTERISTIC:
-                await self._read_hid_info(char)
+                read_tasks.append(self._read_hid_info(char))
 
             elif char.uuid == GATT_HID_REPORT_MAP_CHARACTERISTIC:
-                await self._read_report_map(char)
+                read_tasks.append(self._read_report_map(char))
 
             elif char.uuid == GATT_HID_REPORT_CHARACTERISTIC:
-                ref = await self._process_report_characteristic(char, cache)
-                if ref:
-                    report_refs[str(char.handle)] = ref
+                report_chars.append(char)
+
+        results = await asyncio.gather(
+            *read_tasks,
+            *(self._process_report_characteristic(char, cache)
+              for char in report_chars)
+        )
+
+        for char, ref in zip(report_chars, results[len(read_tasks):]):
+            if ref:
+                report_refs[str(char.handle)] = ref
 
         # Update cache
         await self._update_cache(report_refs, characteristics_to_cache)
 
+        self._install_decoder(cache)
+
         return True
 
+    def _install_decoder(self, cache):
+        """Compile (or restore) the report decoder for the button handler.
+
+        Prefers the pre-compiled layout in the cache so reconnects skip
+        descriptor parsing; otherwise compiles from the report map and
+        stores the result for next time. Decode falls back to fixed
+        offsets if neither works.
+        """
+        decoder = None
+        try:
+            if cache and cache.get('decoder'):
+                decoder = ReportDecoder.from_cache(cache['decoder'])
+                log.detail("Report decoder restored from cache")
+            elif self.report_map:
+                decoder = ReportDecoder.from_report_map(self.report_map)
+                log.detail("Report decoder compiled from report map")
+                # Write-behind: persist the compiled layout without
+                # blocking connection setup on a flash write
+                asyncio.ensure_future(self.gatt_cache.update_async(
+                    self.address,
+                    {'decoder': decoder.to_cache()}
+                ))
+        except Exception as e:
+            logging.warning(f"Report decoder unavailable, "
+                            f"using fixed offsets: {e}")
+
+        if decoder:
+            self.button_handler.set_decoder(decoder)
+
     async def subscribe_to_reports(self):
-        """Subscribe to HID input report notifications."""
-        for report_id, char in self.hid_reports.items():
-            try:
-                await self.peer.subscribe(char, self._on_hid_report)
+        """Subscribe to HID input report notifications.
+
+        If subscription fails on attributes restored from cache, the
+        cache entry is cleared so the next cycle runs a real discovery
+        (handles may have changed after a firmware update).
+        """
+        # CCCD writes are independent - issue them concurrently so N
+        # subscriptions cost ~1 connection interval instead of N
+        reports = list(self.hid_reports.items())
+        results = await asyncio.gather(
+            *(self.peer.subscribe(char, self._on_hid_report)
+              for _, char in reports),
+            return_exceptions=True
+        )
+
+        failures = 0
+        for (report_id, _), result in zip(reports, results):
+            if isinstance(result, Exception):
+                failures += 1
+                log.warning(f"Failed to subscribe to report {report_id}: {result}")
+            else:
                 log.success(f"Subscribed to input report {report_id}")
-            except Exception as e:
-                log.warning(f"Failed to subscribe to report {report_id}: {e}")
 
-    async def connect_and_setup(self, target_address: str):
-        """Connect to device and set up HID service.
+        if failures and self._restored_from_cache:
+            log.warning("Subscription failed on cache-restored attributes - "
+                        "clearing cache to force rediscovery")
+            self.gatt_cache.clear(self.address)
+            self._restored_from_cache = False
 
-        This method handles connection establishment only, not idle waiting.
-        Use wait_for_disconnection() after this to wait for HID reports.
+        if self.hid_reports and failures == len(self.hid_reports):
+            raise Exception("All report subscriptions failed")
 
-        Args:
-            target_address: Device address to connect to
+    async def connect_and_setup(self):
+        """Connect to the session's device and set up its HID service.
+
+        Connection establishment (advertisement wait + create connection)
+        is serialized through the host's connect lock - the controller
+        only supports one pending LE create-connection - but pairing,
+        discovery, and subscription run concurrently with other sessions.
 
         Raises:
             Exception: If connection or setup fails
         """
         self.disconnection_event = asyncio.Event()
 
+        # Sessions outlive a full host teardown (Kindle resume, forced
+        # cleanup after a cycle timeout) but their dispatch backends do
+        # not - bring the executor pool / UHID keyboard back before
+        # reports can arrive on the new connection
+        self.button_handler.ensure_backends()
+
         def on_disconnection(reason):
-            log.error(f"Disconnected: reason={reason}")
+            log.error(f"Disconnected from {self.address}: reason={reason}")
             self.button_handler.execute_disconnect_script()
             self.disconnection_event.set()
 
-        await self.start()
+        async with self.host.connect_lock:
+            # Scan-gated connect: wait until the remote is actually
+            # advertising so the connect attempt lands immediately
+            # instead of babysitting a blind create-connection. With
+            # auto-connect the controller does its own scanning, so the
+            # host-side scan would just duplicate the radio work
+            if config.scan_before_connect and not config.auto_connect:
+                rssi = await self.host.wait_for_advertisement(
+                    self.address, config.connect_timeout
+                )
+                if rssi is None:
+                    raise Exception("Device not advertising")
+                self.last_rssi = rssi
+                self.last_adv_at = time.monotonic()
 
-        if target_address:
-            connected = await self.connect(target_address)
-            if not connected:
-                raise Exception("Connection failed")
-        else:
-            target_address = await self._interactive_scan()
-            if not target_address:
-                raise Exception("No device selected")
-            connected = await self.connect(target_address)
-            if not connected:
+            if not await self.connect():
                 raise Exception("Connection failed")
 
         # Set disconnection handler
         self.connection.on('disconnection', on_disconnection)
 
-        # Pair
-        if not await self.pair():
-            raise Exception("Pairing failed")
+        bonded = await self.gatt_cache.is_bonded_async(self.address)
 
-        # Discover HID service
-        if not await self.discover_hid_service():
-            raise Exception("HID service discovery failed")
+        if bonded:
+            # Fast path: the stored keys were verified last cycle, so
+            # start encryption directly and run setup concurrently -
+            # ATT reads of the (unprotected) HID attributes don't need
+            # to wait for encryption to complete
+            encrypted, discovered = await asyncio.gather(
+                self._fast_encrypt(),
+                self.discover_hid_service(),
+            )
+            if not encrypted:
+                # Keys went stale (remote re-paired elsewhere): drop
+                # the flag and fall back to the full pair() flow with
+                # its keystore probe and SMP fallback
+                await self.gatt_cache.set_bonded_async(self.address, False)
+                if not await self.pair():
+                    raise Exception("Pairing failed")
+            if not discovered:
+                raise Exception("HID service discovery failed")
+        else:
+            if not await self.pair():
+                raise Exception("Pairing failed")
+
+            if not await self.discover_hid_service():
+                raise Exception("HID service discovery failed")
 
         await self.subscribe_to_reports()
-        log.success("\nReceiving HID reports. Press Ctrl+C to exit.")
+
+        # Remember the verified bond (write-behind) so the next
+        # reconnect takes the fast path
+        if not bonded:
+            asyncio.ensure_future(
+                self.gatt_cache.set_bonded_async(self.address, True))
+        log.success(f"\nReceiving HID reports from "
+                    f"{self.device_name or self.address}.")
 
     async def wait_for_disconnection(self):
         """Wait for disconnection event.
 
-        Call this after connect_and_setup() to wait indefinitely for HID reports
-        until the device disconnects.
+        Call this after connect_and_setup() to wait indefinitely for HID
+        reports until the device disconnects.
         """
         if not self.disconnection_event:
             raise Exception("Must call connect_and_setup() first")
 
         try:
             await self.disconnection_event.wait()
-            log.warning("\nConnection terminated")
+            log.warning(f"\nConnection to {self.address} terminated")
         except asyncio.CancelledError:
-            log.warning("\nConnection cancelled")
+            log.warning(f"\nConnection to {self.address} cancelled")
             raise
         finally:
             await self.cleanup()
             log.warning("Wait completed, returning to caller")
 
-    async def run(self, target_address: str):
-        """Main connection loop (legacy method for standalone use).
-
-        Args:
-            target_address: Device address to connect to
-        """
-        try:
-            await self.connect_and_setup(target_address)
-            await self.wait_for_disconnection()
-        except KeyboardInterrupt:
-            log.warning("\nInterrupted by user")
-        except asyncio.CancelledError:
-            log.warning("\nConnection cancelled")
-        except Exception as e:
-            log.error(f"Error: {e}")
-            logging.exception("Error in run()")
-        finally:
-            await self.cleanup()
-            log.warning("Run method completed, returning to caller")
-
     async def cleanup(self):
-        """Clean up resources."""
+        """Release per-connection state (the shared transport stays up)."""
+        if self._idle_revert_task:
+            self._idle_revert_task.cancel()
+            self._idle_revert_task = None
+        self._conn_profile = None
+        self._profile_request_pending = False
+
         if self.connection:
             try:
                 await self.connection.disconnect()
             except Exception:
                 pass
-        if self.transport:
-            await self.transport.close()
+            self.connection = None
+            self.peer = None
+
+        # Per-connection state - rebuilt on the next connect
+        self.hid_reports = {}
+        self._restored_from_cache = False
+        self._service_handles = None
+        self._hid_info_hex = None
 
     # Private helper methods
 
@@ -514,8 +773,17 @@ class BLEHIDHost:
         log.error(f"Pairing failed: {reason}")
 
     def _on_hid_report(self, value):
-        """Handle incoming HID report."""
-        self.button_handler.handle_report(bytes(value))
+        """Handle incoming HID report.
+
+        Timestamps the notification on arrival so downstream stages can
+        attribute end-to-end latency (see metrics.py stage names).
+        """
+        received_at = time.monotonic()
+
+        if config.adaptive_connection_params:
+            self._note_input_activity()
+
+        self.button_handler.handle_report(bytes(value), received_at=received_at)
 
     async def _read_device_name(self):
         """Read device name from Generic Access Service."""
@@ -533,6 +801,61 @@ class BLEHIDHost:
         except Exception as e:
             logging.warning(f"Could not read device name: {e}")
 
+    async def _restore_from_cache(self, cache) -> bool:
+        """Rebuild the full HID attribute database from a v2 cache entry.
+
+        No ATT traffic at all: service handle range, characteristics,
+        descriptors, and report references all come from the cache, so a
+        bonded reconnect goes straight from pair() to the CCCD writes.
+
+        Args:
+            cache: Complete cache entry (see GATTCache.is_complete)
+
+        Returns:
+            True if the attribute database was restored
+        """
+        try:
+            self.report_map = bytes.fromhex(cache['report_map'])
+            if cache.get('device_name'):
+                self.device_name = cache['device_name']
+                log.info(f"Device Name: {self.device_name} (cached)")
+
+            hid_service = Service(
+                uuid=GATT_HID_SERVICE,
+                characteristics=[],
+                primary=True
+            )
+            hid_service.handle = cache['service_handles']['start']
+            hid_service.end_group_handle = cache['service_handles']['end']
+
+            if not await self._load_cached_characteristics(hid_service, cache):
+                return False
+
+            # Register input report characteristics from cached references
+            self.hid_reports = {}
+            for char in hid_service.characteristics:
+                if char.uuid != GATT_HID_REPORT_CHARACTERISTIC:
+                    continue
+                ref = cache['report_refs'].get(str(char.handle))
+                if ref and ref['type'] == HID_REPORT_TYPE_INPUT:
+                    self.hid_reports[ref['id']] = char
+
+            if not self.hid_reports:
+                logging.warning("Cache entry has no input report references")
+                return False
+
+            self.peer.services.append(hid_service)
+            self._install_decoder(cache)
+            self._restored_from_cache = True
+            log.success(f"Restored attribute database from cache "
+                        f"({len(hid_service.characteristics)} characteristics, "
+                        f"zero discovery round trips)")
+            return True
+
+        except Exception as e:
+            logging.warning(f"Failed to restore from cache: {e}")
+            return False
+
     async def _load_cached_characteristics(self, hid_service, cache) -> bool:
         """Load characteristics from cache."""
         log.info("Loading characteristics from cache...")
@@ -596,6 +919,7 @@ class BLEHIDHost:
         """Read HID Information characteristic."""
         try:
             value = await self.peer.read_value(char)
+            self._hid_info_hex = bytes(value).hex()
             if len(value) >= 4:
                 flags = value[3]
                 device_type = flags & 0x03
@@ -617,13 +941,12 @@ class BLEHIDHost:
             log.detail(f"Report Map: {len(self.report_map)} bytes")
             log.detail(f"Report Map (hex): {self.report_map.hex()}")
 
-            # Save to cache
-            if self.current_device_address:
-                cache_data = {
-                    'report_map': self.report_map.hex(),
-                    'device_name': self.device_name
-                }
-                self.gatt_cache.save(self.current_device_address, cache_data)
+            # Save to cache (off the event loop)
+            cache_data = {
+                'report_map': self.report_map.hex(),
+                'device_name': self.device_name
+            }
+            await self.gatt_cache.save_async(self.address, cache_data)
         except Exception as e:
             log.error(f"Failed to read report map: {e}")
 
@@ -668,7 +991,7 @@ class BLEHIDHost:
 
     async def _update_cache(self, report_refs: dict, characteristics: list):
         """Update GATT cache with new data."""
-        if not (report_refs or characteristics) or not self.current_device_address:
+        if not (report_refs or characteristics):
             log.success("All data loaded from cache")
             return
 
@@ -680,7 +1003,7 @@ class BLEHIDHost:
                 updates.append(f"{len(characteristics)} characteristics")
             log.info(f"Updating cache with {', '.join(updates)}...")
 
-            existing = self.gatt_cache.load(self.current_device_address) or {}
+            existing = await self.gatt_cache.load_async(self.address) or {}
 
             if report_refs:
                 if 'report_refs' not in existing:
@@ -694,13 +1017,461 @@ class BLEHIDHost:
                 existing['report_map'] = self.report_map.hex()
             if self.device_name:
                 existing['device_name'] = self.device_name
-
-            self.gatt_cache.save(self.current_device_address, existing)
+            if self._service_handles:
+                existing['service_handles'] = self._service_handles
+            if self._hid_info_hex:
+                existing['hid_info'] = self._hid_info_hex
+
+            # Flag attribute table changes against the previous entry
+            old_hash = existing.get('db_hash')
+            if old_hash and old_hash != self.gatt_cache.compute_db_hash(existing):
+                log.warning("Remote attribute database changed since last "
+                            "discovery (firmware update?)")
+
+            await self.gatt_cache.save_async(self.address, existing)
             log.success("Cache updated successfully")
 
         except Exception as e:
             logging.warning(f"Failed to update cache: {e}")
 
+
+class BLEHIDHost:
+    """BLE HID Host that connects to HID devices and handles input.
+
+    Owns the pieces every connection shares - the HCI transport, the
+    Bumble Device, the key store, the GATT cache - plus a registry of
+    HIDSession objects, one per remote device, so several HID peripherals
+    multiplex over one radio and one event loop. The per-session
+    lifecycle:
+    1. Transport initialization and HCI reset (once, shared)
+    2. Device scanning (optional, shared radio)
+    3. Connection establishment (serialized via connect_lock)
+    4. SMP pairing with key persistence
+    5. GATT service discovery (with caching)
+    6. HID report subscription
+    7. Button event processing
+
+    The single-device methods (connect_and_setup, wait_for_disconnection,
+    run) delegate to a default session so existing callers keep working.
+    """
+
+    def __init__(self, transport_spec: str = None):
+        """Initialize BLE HID Host.
+
+        Args:
+            transport_spec: HCI transport (default: from config)
+        """
+        # First host construction pays the Bumble import; by now config
+        # and devices.conf have been validated, so a misconfigured
+        # daemon has already failed in milliseconds
+        _import_bumble()
+
+        self.transport_spec = transport_spec or config.transport
+        self.device = None
+        self.transport = None
+
+        # Shared components
+        self.gatt_cache = GATTCache(config.cache_dir)
+        self.keystore = create_keystore(config.pairing_keys_file)
+
+        # HCI trace ring (one ring across transport re-inits, so a dump
+        # can still show the packets leading up to a controller reset)
+        self.hci_trace = HCITraceRing() if config.hci_trace else None
+
+        # Per-peer sessions, keyed by upper-cased address
+        self.sessions: Dict[str, HIDSession] = {}
+        self._default_session = None
+
+        # The controller handles one pending LE create-connection (and
+        # one scan) at a time; sessions serialize establishment on this
+        self.connect_lock = asyncio.Lock()
+        self._start_lock = asyncio.Lock()
+
+        # State
+        self.last_rssi = None  # RSSI of the last advertisement seen from a target
+        self._powered_on = False  # True while transport is open and device powered
+
+        # Weakrefs to Bumble Devices discarded by transport re-inits;
+        # one surviving a later GC pass means something is pinning the
+        # whole retired stack (see sweep_retired)
+        self._retired = []
+        self._retired_warned = 0
+
+    def session(self, address: str) -> HIDSession:
+        """Get (or create) the session for a device address.
+
+        Args:
+            address: BLE device address
+
+        Returns:
+            The HIDSession for that address
+        """
+        key = address.upper()
+        if key not in self.sessions:
+            self.sessions[key] = HIDSession(self, address)
+        return self.sessions[key]
+
+    def any_connected(self) -> bool:
+        """Check whether any session currently holds a connection."""
+        return any(s.connection for s in self.sessions.values())
+
+    def dump_hci_trace(self, reason: str = ''):
+        """Write the HCI trace ring to the configured btsnoop file.
+
+        Triggered by SIGUSR2 and automatically by the daemon when a
+        connection cycle fails with the device in sight. The file write
+        runs in an executor when called from the event loop.
+
+        Args:
+            reason: Short description for the log line
+        """
+        if not self.hci_trace or len(self.hci_trace) == 0:
+            return
+
+        log.info(f"Dumping HCI trace to {config.hci_trace_file}"
+                 + (f" ({reason})" if reason else ""))
+        try:
+            loop = asyncio.get_running_loop()
+        except RuntimeError:
+            self.hci_trace.dump(config.hci_trace_file)
+            return
+        loop.run_in_executor(None, self.hci_trace.dump, config.hci_trace_file)
+
+    def sweep_retired(self) -> int:
+        """Count retired Bumble Devices still alive after a GC pass.
+
+        Each transport re-init parks a weakref to the Device it
+        discards. A ref surviving gc.collect() means a stale listener
+        or connection is pinning the whole retired stack - the exact
+        slow leak that creeps RSS over weeks of reconnect cycles. Warns
+        once per new leaked object, not per sweep.
+
+        Returns:
+            Number of retired devices still referenced
+        """
+        self._retired = [ref for ref in self._retired if ref() is not None]
+        alive = len(self._retired)
+        if alive > self._retired_warned:
+            log.warning(f"{alive} retired Bumble Device object(s) still "
+                        "referenced after GC (possible leak)")
+        self._retired_warned = alive
+        return alive
+
+    async def start(self):
+        """Initialize the Bumble device and BLE stack.
+
+        Safe to call from several session loops: the first call opens the
+        transport, later calls reuse it. In persistent-transport mode the
+        open transport and powered-on device are reused across connection
+        cycles: a quick liveness probe checks the controller is still
+        responsive, and only if it fails (e.g. BT hardware wedged after
+        Kindle resume) is the full open-transport/HCI-reset/power-on
+        sequence re-run.
+
+        Raises:
+            asyncio.TimeoutError: If transport or HCI reset times out
+        """
+        async with self._start_lock:
+            if self._powered_on:
+                if not config.persistent_transport:
+                    # Another session already powered the radio on
+                    return
+                if await self._probe_controller():
+                    log.success("Reusing open transport (controller responsive)")
+                    return
+                log.warning("Controller liveness probe failed - reinitializing transport")
+                await self._close_transport()
+
+            log.info(f"Kindle BLE HID Host v{__version__}")
+            log.info("Opening transport...")
+
+            opened_at = time.monotonic()
+            try:
+                self.transport = await asyncio.wait_for(
+                    open_transport(self.transport_spec),
+                    timeout=config.transport_timeout
+                )
+            except asyncio.TimeoutError:
+                log.error(f"Transport open timed out after {config.transport_timeout}s")
+                raise
+
+            transport_ms = (time.monotonic() - opened_at) * 1000.0
+            metrics.set_gauge('transport_open_ms', round(transport_ms, 1))
+            log.detail(f"Transport opened in {transport_ms:.0f}ms")
+
+            # Create Bumble device (HCI endpoints optionally wrapped by
+            # the trace ring - two delegating objects, no copies)
+            source, sink = self.transport.source, self.transport.sink
+            if self.hci_trace is not None:
+                source, sink = wrap_transport(self.transport, self.hci_trace)
+            self.device = Device.with_hci(
+                config.device_name,
+                config.device_address,
+                source,
+                sink
+            )
+
+            # Attach key store and pairing config
+            self.device.keystore = self.keystore
+            self.device.pairing_config_factory = lambda conn: create_pairing_config()
+
+            # HCI Reset - critical for sleep recovery
+            log.info("Sending HCI Reset...")
+            try:
+                await asyncio.wait_for(
+                    self.device.host.send_command(HCI_Reset_Command()),
+                    timeout=config.hci_reset_timeout
+                )
+                log.success("HCI Reset successful")
+            except asyncio.TimeoutError:
+                log.error(f"HCI Reset timed out after {config.hci_reset_timeout}s - "
+                         "BT hardware may be asleep")
+                raise
+
+            await self.device.power_on()
+            self._powered_on = True
+            log.success(f"Device powered on: {self.device.public_address}")
+
+    async def _probe_controller(self) -> bool:
+        """Check that the controller still responds to HCI commands.
+
+        Uses a lightweight read-only command so the probe is cheap compared
+        to a full HCI reset.
+
+        Returns:
+            True if the controller answered within the probe timeout
+        """
+        if not self.device:
+            return False
+
+        try:
+            await asyncio.wait_for(
+                self.device.host.send_command(
+                    HCI_Read_Local_Version_Information_Command()
+                ),
+                timeout=config.liveness_probe_timeout
+            )
+            return True
+        except Exception as e:
+            log.detail(f"Liveness probe failed: {e}")
+            return False
+
+    async def _close_transport(self):
+        """Tear down the transport and Bumble device completely."""
+        self._powered_on = False
+        if self.transport:
+            try:
+                await self.transport.close()
+            except Exception as e:
+                logging.warning(f"Transport close error: {e}")
+            self.transport = None
+        if self.device is not None:
+            # Track the discarded Device: it should be unreachable once
+            # the sessions drop their connections
+            self._retired.append(weakref.ref(self.device))
+        self.device = None
+
+    async def scan(self, duration: float = 10.0, filter_hid: bool = True):
+        """Scan for BLE devices.
+
+        Args:
+            duration: Scan duration in seconds
+            filter_hid: If True, only return devices advertising HID service
+
+        Returns:
+            List of device dicts with address, name, rssi, is_hid
+        """
+        log.info(f"Scanning for {duration} seconds...")
+
+        devices_found = []
+        seen_addresses = set()
+
+        def on_advertisement(advertisement):
+            addr_str = str(advertisement.address)
+
+            if addr_str in seen_addresses:
+                return
+            seen_addresses.add(addr_str)
+
+            # Extract device name
+            name = 'Unknown'
+            if hasattr(advertisement, 'data') and advertisement.data:
+                name = advertisement.data.get(AdvertisingData.COMPLETE_LOCAL_NAME)
+                if not name:
+                    name = advertisement.data.get(AdvertisingData.SHORTENED_LOCAL_NAME)
+                if not name:
+                    name = 'Unknown'
+                if isinstance(name, bytes):
+                    name = name.decode('utf-8', errors='replace')
+
+            # Check for HID service
+            is_hid = False
+            if hasattr(advertisement, 'data') and advertisement.data:
+                services = advertisement.data.get(
+                    AdvertisingData.COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS
+                )
+                if not services:
+                    services = advertisement.data.get(
+                        AdvertisingData.INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS
+                    )
+                if services:
+                    for service_uuid in services:
+                        if service_uuid == GATT_HID_SERVICE:
+                            is_hid = True
+                            break
+
+            if not filter_hid or is_hid:
+                entry = {
+                    'address': addr_str,
+                    'name': name,
+                    'rssi': advertisement.rssi,
+                    'is_hid': is_hid,
+                }
+                devices_found.append(entry)
+                hid_marker = " [HID]" if is_hid else ""
+                log.detail(f"Found: {entry['name']} ({entry['address']}) "
+                          f"RSSI: {entry['rssi']}{hid_marker}")
+
+        self.device.on('advertisement', on_advertisement)
+        await self.device.start_scanning(filter_duplicates=True)
+        await asyncio.sleep(duration)
+        await self.device.stop_scanning()
+
+        log.success(f"Scan complete. Found {len(devices_found)} devices.")
+        return devices_found
+
+    @staticmethod
+    def _address_matches(adv_address, address: str) -> bool:
+        """Compare an advertisement address against a configured address.
+
+        Ignores the address-type qualifier Bumble may append when
+        stringifying, so devices.conf entries match as written.
+        """
+        return str(adv_address).upper().split('/')[0] == address.upper()
+
+    async def wait_for_advertisement(self, address: str,
+                                     timeout: float) -> Optional[int]:
+        """Passively scan until the target device advertises.
+
+        Ends the scan the instant the target is seen instead of sleeping
+        out a fixed duration, so the connect can fire within one
+        advertising interval of the remote waking up.
+
+        Args:
+            address: Target BLE device address
+            timeout: Maximum time to wait in seconds
+
+        Returns:
+            Advertisement RSSI if the target was seen, None on timeout
+        """
+        log.info(f"Waiting for advertisement from {address} "
+                 f"(up to {timeout}s)...")
+
+        seen = asyncio.Event()
+
+        def on_advertisement(advertisement):
+            if self._address_matches(advertisement.address, address):
+                self.last_rssi = advertisement.rssi
+                seen.set()
+
+        self.device.on('advertisement', on_advertisement)
+        try:
+            await self.device.start_scanning(
+                active=False,  # passive: no scan requests needed
+                filter_duplicates=False
+            )
+            try:
+                await asyncio.wait_for(seen.wait(), timeout=timeout)
+            except asyncio.TimeoutError:
+                log.warning(f"Target did not advertise within {timeout}s")
+                return None
+
+            log.success(f"Target advertising (RSSI: {self.last_rssi})")
+            return self.last_rssi
+
+        finally:
+            self.device.remove_listener('advertisement', on_advertisement)
+            try:
+                await self.device.stop_scanning()
+            except Exception as e:
+                logging.warning(f"Failed to stop scanning: {e}")
+
+    async def connect_and_setup(self, target_address: str):
+        """Connect to a single device and set up its HID service.
+
+        Legacy single-device entry point: resolves (or interactively
+        scans for) the target and drives its session. Use
+        wait_for_disconnection() after this to wait for HID reports.
+
+        Args:
+            target_address: Device address to connect to (scans if empty)
+
+        Raises:
+            Exception: If connection or setup fails
+        """
+        await self.start()
+
+        if not target_address:
+            target_address = await self._interactive_scan()
+            if not target_address:
+                raise Exception("No device selected")
+
+        session = self.session(target_address)
+        self._default_session = session
+        await session.connect_and_setup()
+
+    async def wait_for_disconnection(self):
+        """Wait for the default session's disconnection event.
+
+        Call this after connect_and_setup() to wait indefinitely for HID
+        reports until the device disconnects.
+        """
+        if not self._default_session:
+            raise Exception("Must call connect_and_setup() first")
+
+        await self._default_session.wait_for_disconnection()
+
+    async def run(self, target_address: str):
+        """Main connection loop (legacy method for standalone use).
+
+        Args:
+            target_address: Device address to connect to
+        """
+        try:
+            await self.connect_and_setup(target_address)
+            await self.wait_for_disconnection()
+        except KeyboardInterrupt:
+            log.warning("\nInterrupted by user")
+        except asyncio.CancelledError:
+            log.warning("\nConnection cancelled")
+        except Exception as e:
+            log.error(f"Error: {e}")
+            logging.exception("Error in run()")
+        finally:
+            await self.cleanup()
+            log.warning("Run method completed, returning to caller")
+
+    async def cleanup(self, close_transport: Optional[bool] = None):
+        """Clean up all sessions (and optionally the transport).
+
+        Args:
+            close_transport: Force transport close (True) or keep it open
+                (False). Defaults to keeping the transport in
+                persistent-transport mode so the next cycle skips the
+                open/reset/power-on sequence.
+        """
+        if close_transport is None:
+            close_transport = not config.persistent_transport
+
+        for session in self.sessions.values():
+            await session.cleanup()
+
+        if close_transport:
+            await self._close_transport()
+            # Full teardown also releases the executor pool workers
+            for session in self.sessions.values():
+                session.button_handler.shutdown()
+
     async def _interactive_scan(self) -> Optional[str]:
         """Scan and let user select a device."""
         devices = []
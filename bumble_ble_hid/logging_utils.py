@@ -8,7 +8,12 @@ and colored output for the BLE HID system.
 Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
+import collections
+import gzip
 import logging
+import os
+import shutil
+import threading
 import time
 from typing import Optional
 
@@ -19,7 +24,133 @@ except ImportError:
     def bumble_color(text, _color):
         return text
 
-__all__ = ['log', 'color', 'setup_logging', 'setup_daemon_logging']
+__all__ = ['log', 'color', 'setup_logging', 'setup_daemon_logging',
+           'flush_logs', 'BufferedFileHandler']
+
+
+class BufferedFileHandler(logging.Handler):
+    """File handler that batches records and flushes from a background thread.
+
+    A plain FileHandler does a synchronous write+flush to the Kindle's
+    slow eMMC for every record - inside the asyncio event loop when
+    logging from the report path. This handler formats records into an
+    in-memory ring and a daemon thread writes them out in batches when
+    either flush_count records accumulate or flush_interval seconds pass,
+    which also cuts flash wear from the chatty reconnect loop.
+
+    If the ring overflows (sustained burst faster than the flush thread),
+    oldest records are dropped and the drop count is noted in the output.
+    Call flush() to force a synchronous drain (disconnect/shutdown).
+
+    With max_bytes set the file is rotated once it passes that size:
+    the live file is gzip'd to <file>.1.gz (predecessors shift up, the
+    oldest beyond backup_count is dropped) and truncated. Rotation
+    happens on whichever thread ran the flush - normally the background
+    writer - so the emit hot path never pays for compression, and
+    /var/log stays bounded over months of reconnect cycles.
+    """
+
+    def __init__(self, filename: str, capacity: int = 512,
+                 flush_count: int = 32, flush_interval: float = 2.0,
+                 max_bytes: int = 0, backup_count: int = 3):
+        super().__init__()
+        self.filename = filename
+        self.flush_count = flush_count
+        self.flush_interval = flush_interval
+        self.max_bytes = max_bytes
+        self.backup_count = backup_count
+
+        self._buffer = collections.deque(maxlen=capacity)
+        self._dropped = 0
+        self._cond = threading.Condition()
+        self._io_lock = threading.Lock()  # serializes write + rotate
+        self._closed = False
+
+        self._thread = threading.Thread(
+            target=self._flush_loop, name='log-flush', daemon=True
+        )
+        self._thread.start()
+
+    def emit(self, record):
+        try:
+            line = self.format(record)
+        except Exception:
+            self.handleError(record)
+            return
+
+        with self._cond:
+            if len(self._buffer) == self._buffer.maxlen:
+                self._dropped += 1
+            self._buffer.append(line)
+            if len(self._buffer) >= self.flush_count:
+                self._cond.notify()
+
+    def flush(self):
+        """Synchronously drain the buffer to disk."""
+        with self._cond:
+            lines = list(self._buffer)
+            self._buffer.clear()
+            dropped, self._dropped = self._dropped, 0
+
+        if dropped:
+            lines.insert(0, f"... {dropped} log records dropped (buffer overflow)")
+        if not lines:
+            return
+
+        try:
+            with self._io_lock:
+                with open(self.filename, 'a') as f:
+                    f.write('\n'.join(lines) + '\n')
+                    size = f.tell()
+                if self.max_bytes and size >= self.max_bytes:
+                    self._rotate()
+        except Exception:
+            pass  # Logging must never take the daemon down
+
+    def _rotate(self):
+        """Compress the live file away and start a fresh one.
+
+        <file>.{i}.gz shift up to make room, the entry past backup_count
+        falls off, the live file is gzip'd to <file>.1.gz and truncated.
+        Called with _io_lock held.
+        """
+        for i in range(self.backup_count - 1, 0, -1):
+            src = f"{self.filename}.{i}.gz"
+            if os.path.exists(src):
+                os.replace(src, f"{self.filename}.{i + 1}.gz")
+
+        with open(self.filename, 'rb') as src, \
+                gzip.open(f"{self.filename}.1.gz", 'wb') as dst:
+            shutil.copyfileobj(src, dst)
+        with open(self.filename, 'w'):
+            pass
+
+    def close(self):
+        with self._cond:
+            self._closed = True
+            self._cond.notify()
+        self._thread.join(timeout=2.0)
+        self.flush()
+        super().close()
+
+    def _flush_loop(self):
+        """Background writer: batch on record count or time threshold."""
+        while True:
+            with self._cond:
+                if not self._closed:
+                    self._cond.wait(timeout=self.flush_interval)
+                if self._closed and not self._buffer:
+                    return
+            self.flush()
+
+
+def flush_logs():
+    """Force all buffered log handlers to disk (disconnect/shutdown)."""
+    for handler in logging.getLogger().handlers:
+        try:
+            handler.flush()
+        except Exception:
+            pass
 
 
 def color(text: str, color_name: str) -> str:
@@ -125,8 +256,18 @@ def setup_logging(debug: bool = False):
     logging.getLogger('ble_hid').setLevel(log_level)
 
 
-def setup_daemon_logging(log_file: str):
-    """Setup logging for daemon mode (file only, no console)"""
+def setup_daemon_logging(log_file: str, buffered: bool = True,
+                         max_bytes: int = 0, backup_count: int = 3):
+    """Setup logging for daemon mode (file only, no console).
+
+    Args:
+        log_file: Path to the daemon log file
+        buffered: Use the batched background writer (True, default) or a
+            plain synchronous FileHandler (debugging aid; no rotation)
+        max_bytes: Rotate the log once it passes this size, keeping
+            backup_count gzip'd predecessors (0 disables rotation)
+        backup_count: Number of compressed rotated files to keep
+    """
     root_logger = logging.getLogger()
 
     # Remove all existing handlers
@@ -134,7 +275,11 @@ def setup_daemon_logging(log_file: str):
         root_logger.removeHandler(handler)
 
     # Create file handler
-    file_handler = logging.FileHandler(log_file)
+    if buffered:
+        file_handler = BufferedFileHandler(log_file, max_bytes=max_bytes,
+                                           backup_count=backup_count)
+    else:
+        file_handler = logging.FileHandler(log_file)
     formatter = logging.Formatter('%(asctime)s %(levelname)s %(name)s: %(message)s')
     file_handler.setFormatter(formatter)
     root_logger.addHandler(file_handler)
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Runtime Metrics
+
+Hot-path latency instrumentation and counters for the BLE HID system.
+Latency samples are stored in fixed-size rings keyed by stage name, so
+recording from the report path is a couple of list operations and never
+allocates once warm. Percentiles are computed lazily when a snapshot is
+requested (SIGUSR1 dump or status query), keeping the hot path cheap on
+the Kindle's single core.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import time
+from typing import Dict, Optional
+
+__all__ = ['metrics', 'Metrics', 'LatencyHistogram']
+
+# Stage names used by the report hot path
+# (notification arrival -> mapper decode -> script launch)
+STAGE_DECODE = 'report_decode'        # _on_hid_report -> mapper decision
+STAGE_DISPATCH = 'script_dispatch'    # script launch call itself
+STAGE_TOTAL = 'press_to_launch'       # notification arrival -> script launched
+
+
+class LatencyHistogram:
+    """Rolling latency histogram backed by a fixed-size sample ring.
+
+    Samples are recorded in seconds (monotonic-clock deltas) and reported
+    in milliseconds. The ring keeps the most recent `capacity` samples so
+    percentiles reflect current behaviour, not daemon lifetime averages.
+    """
+
+    __slots__ = ('name', '_capacity', '_samples', '_next', '_total_count')
+
+    def __init__(self, name: str, capacity: int = 256):
+        self.name = name
+        self._capacity = capacity
+        self._samples = []
+        self._next = 0
+        self._total_count = 0
+
+    def record(self, seconds: float):
+        """Record one latency sample (cheap, hot-path safe)."""
+        if len(self._samples) < self._capacity:
+            self._samples.append(seconds)
+        else:
+            self._samples[self._next] = seconds
+            self._next = (self._next + 1) % self._capacity
+        self._total_count += 1
+
+    def snapshot(self) -> Dict:
+        """Compute percentile summary over the current sample window.
+
+        Returns:
+            Dict with count, window size, and p50/p95/p99/max in ms
+        """
+        if not self._samples:
+            return {'count': 0}
+
+        ordered = sorted(self._samples)
+        n = len(ordered)
+
+        def pct(p: float) -> float:
+            idx = min(n - 1, int(p * n))
+            return round(ordered[idx] * 1000.0, 3)
+
+        return {
+            'count': self._total_count,
+            'window': n,
+            'p50_ms': pct(0.50),
+            'p95_ms': pct(0.95),
+            'p99_ms': pct(0.99),
+            'max_ms': round(ordered[-1] * 1000.0, 3),
+        }
+
+
+class Metrics:
+    """Process-wide metrics registry (histograms and counters).
+
+    Used as a single shared instance (`metrics`), mirroring the config
+    and log singletons.
+    """
+
+    def __init__(self):
+        self._histograms: Dict[str, LatencyHistogram] = {}
+        self._counters: Dict[str, int] = {}
+        self._started_at = time.monotonic()
+
+    def histogram(self, name: str) -> LatencyHistogram:
+        """Get (or create) the named latency histogram."""
+        hist = self._histograms.get(name)
+        if hist is None:
+            hist = LatencyHistogram(name)
+            self._histograms[name] = hist
+        return hist
+
+    def record_latency(self, name: str, seconds: float):
+        """Record a latency sample into the named histogram."""
+        self.histogram(name).record(seconds)
+
+    def incr(self, name: str, amount: int = 1):
+        """Increment a named counter."""
+        self._counters[name] = self._counters.get(name, 0) + amount
+
+    def set_gauge(self, name: str, value):
+        """Set a named gauge-style value (overwrites previous)."""
+        self._counters[name] = value
+
+    def get(self, name: str, default: int = 0):
+        """Read back a counter/gauge value."""
+        return self._counters.get(name, default)
+
+    def snapshot(self) -> Dict:
+        """Full snapshot of all counters and histogram summaries."""
+        return {
+            'uptime_s': round(time.monotonic() - self._started_at, 1),
+            'counters': dict(self._counters),
+            'latency': {
+                name: hist.snapshot()
+                for name, hist in self._histograms.items()
+            },
+        }
+
+    def log_summary(self, logger: Optional[object] = None):
+        """Write a human-readable summary through the given logger.
+
+        Args:
+            logger: Object with an info() method (defaults to the module
+                logger so the SIGUSR1 handler needs no arguments)
+        """
+        if logger is None:
+            import logging
+            logger = logging.getLogger(__name__)
+
+        snap = self.snapshot()
+        logger.info(f"=== Metrics (uptime {snap['uptime_s']}s) ===")
+        for name in sorted(snap['counters']):
+            logger.info(f"  {name}: {snap['counters'][name]}")
+        for name in sorted(snap['latency']):
+            stats = snap['latency'][name]
+            if stats['count'] == 0:
+                continue
+            logger.info(
+                f"  {name}: n={stats['count']} "
+                f"p50={stats['p50_ms']}ms p95={stats['p95_ms']}ms "
+                f"p99={stats['p99_ms']}ms max={stats['max_ms']}ms"
+            )
+
+
+# Global shared instance
+metrics = Metrics()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+Metrics Server
+
+Serves the process-wide metrics snapshot (counters and latency
+histograms, see metrics.py) as JSON over a local Unix socket. One
+snapshot per connection, then the connection closes - cheap enough for
+`just metrics` or a status script to poll every few seconds without
+disturbing the event loop (the snapshot is a dict copy plus one sort
+per histogram window).
+
+Run this module directly to query a running daemon:
+
+    python3 metrics_server.py            # pretty-printed snapshot
+    python3 metrics_server.py --raw      # raw JSON (for scripts/jq)
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import asyncio
+import json
+import os
+import sys
+from typing import Callable, Optional
+
+# Add the bumble_ble_hid directory to path for Kindle deployment
+sys.path.insert(0, '/mnt/us/bumble_ble_hid')
+
+from config import config
+from logging_utils import log
+from metrics import metrics
+
+__all__ = ['MetricsServer']
+
+
+class MetricsServer:
+    """Unix-socket endpoint serving a JSON metrics snapshot per connect.
+
+    The served document is metrics.snapshot() merged with whatever the
+    optional extra-snapshot callable returns, which is how the daemon
+    contributes its own state (per-device timeouts, session status).
+    """
+
+    def __init__(self, path: Optional[str] = None,
+                 extra_snapshot: Optional[Callable[[], dict]] = None):
+        """Initialize the server (does not bind yet - see start()).
+
+        Args:
+            path: Socket path (default: from config)
+            extra_snapshot: Callable returning extra top-level fields to
+                merge into each served snapshot
+        """
+        self.path = path or config.metrics_socket
+        self._extra_snapshot = extra_snapshot
+        self._server = None
+
+    async def start(self):
+        """Bind the socket and start serving."""
+        # A previous unclean shutdown leaves the socket file behind;
+        # binding over it requires removing it first
+        try:
+            os.unlink(self.path)
+        except FileNotFoundError:
+            pass
+        except OSError as e:
+            log.warning(f"Could not remove stale metrics socket: {e}")
+
+        try:
+            self._server = await asyncio.start_unix_server(
+                self._serve, path=self.path
+            )
+            log.info(f"Metrics endpoint listening on {self.path}")
+        except OSError as e:
+            # Observability is best-effort: never block the daemon on it
+            log.warning(f"Metrics endpoint unavailable: {e}")
+            self._server = None
+
+    async def stop(self):
+        """Stop serving and remove the socket file."""
+        if self._server:
+            self._server.close()
+            await self._server.wait_closed()
+            self._server = None
+        try:
+            os.unlink(self.path)
+        except OSError:
+            pass
+
+    async def _serve(self, reader, writer):
+        """Write one snapshot and close (no request parsing needed)."""
+        try:
+            snapshot = metrics.snapshot()
+            if self._extra_snapshot:
+                try:
+                    snapshot.update(self._extra_snapshot())
+                except Exception as e:
+                    snapshot['snapshot_error'] = str(e)
+
+            writer.write(json.dumps(snapshot).encode('utf-8') + b'\n')
+            await writer.drain()
+        except (ConnectionError, OSError):
+            pass  # client went away mid-write; nothing to do
+        finally:
+            writer.close()
+
+
+def query(path: Optional[str] = None) -> dict:
+    """Fetch one snapshot from a running daemon (synchronous client).
+
+    Args:
+        path: Socket path (default: from config)
+
+    Returns:
+        Parsed snapshot dictionary
+
+    Raises:
+        OSError: If the daemon is not running or the socket is missing
+    """
+    import socket
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.settimeout(5.0)
+    try:
+        sock.connect(path or config.metrics_socket)
+        chunks = []
+        while True:
+            data = sock.recv(4096)
+            if not data:
+                break
+            chunks.append(data)
+    finally:
+        sock.close()
+
+    return json.loads(b''.join(chunks).decode('utf-8'))
+
+
+def main():
+    """CLI client: print a snapshot from the running daemon."""
+    try:
+        snapshot = query()
+    except OSError as e:
+        print(f"Cannot reach daemon at {config.metrics_socket}: {e}")
+        print("Is the daemon running? (just status)")
+        return 1
+
+    if '--raw' in sys.argv:
+        print(json.dumps(snapshot))
+        return 0
+
+    print(json.dumps(snapshot, indent=2, sort_keys=True))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -9,6 +9,8 @@ userspace SMP.
 Author: Lucas Zampieri <lzampier@redhat.com>
 """
 
+import asyncio
+
 from bumble.pairing import PairingConfig, PairingDelegate
 from bumble.keys import JsonKeyStore
 
@@ -16,6 +18,7 @@ from logging_utils import log
 
 __all__ = [
     'AutoAcceptPairingDelegate',
+    'CachingKeyStore',
     'create_pairing_config',
     'create_keystore',
 ]
@@ -72,13 +75,85 @@ def create_pairing_config() -> PairingConfig:
     )
 
 
-def create_keystore(path: str) -> JsonKeyStore:
+class CachingKeyStore:
+    """In-memory front for a key store with write-behind persistence.
+
+    pair() hits keystore.get() on every connection attempt, and in a
+    reconnect storm (remote at range edge, supervision timeouts every
+    few seconds) each JsonKeyStore call re-reads or rewrites
+    pairing_keys.json on flash. This wrapper loads the keys into RAM
+    once, serves get() from memory, applies mutations in memory
+    immediately, and flushes them to the backing store as a background
+    task - the file is only touched when keys actually change.
+    """
+
+    def __init__(self, backing_store):
+        """Wrap a backing key store (normally JsonKeyStore).
+
+        Args:
+            backing_store: Key store that actually persists to disk
+        """
+        self._backing = backing_store
+        self._cache = {}
+        self._loaded = False
+
+    async def _ensure_loaded(self):
+        """Load all keys from the backing store once."""
+        if self._loaded:
+            return
+        try:
+            for name, keys in await self._backing.get_all():
+                self._cache[name] = keys
+            log.detail(f"Loaded {len(self._cache)} bonding key entries "
+                       "into memory")
+        except Exception as e:
+            log.warning(f"Could not preload bonding keys: {e}")
+        self._loaded = True
+
+    def _flush(self, coro, what: str):
+        """Persist a mutation without blocking the caller."""
+        async def flush():
+            try:
+                await coro
+            except Exception as e:
+                log.warning(f"Keystore flush failed ({what}): {e}")
+
+        asyncio.ensure_future(flush())
+
+    async def get(self, name):
+        await self._ensure_loaded()
+        return self._cache.get(name)
+
+    async def get_all(self):
+        await self._ensure_loaded()
+        return list(self._cache.items())
+
+    async def update(self, name, keys):
+        await self._ensure_loaded()
+        self._cache[name] = keys
+        self._flush(self._backing.update(name, keys), f"update {name}")
+
+    async def delete(self, name):
+        await self._ensure_loaded()
+        if name not in self._cache:
+            # Nothing changes, so don't rewrite the file either
+            return
+        del self._cache[name]
+        self._flush(self._backing.delete(name), f"delete {name}")
+
+    def __getattr__(self, attr):
+        # Anything else (delete_all, print, ...) goes straight through
+        return getattr(self._backing, attr)
+
+
+def create_keystore(path: str) -> CachingKeyStore:
     """Create a JSON-based key store for bonding keys.
 
     Args:
         path: File path for storing keys (JSON format)
 
     Returns:
-        JsonKeyStore instance that persists pairing keys
+        CachingKeyStore over a JsonKeyStore: reads come from RAM,
+        changes are persisted write-behind
     """
-    return JsonKeyStore(namespace=None, filename=path)
+    return CachingKeyStore(JsonKeyStore(namespace=None, filename=path))
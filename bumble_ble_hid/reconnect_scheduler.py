@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+Adaptive Reconnect Scheduler
+
+Replaces the daemon's flat reconnect_delay sleep between connection
+attempts. A fixed 5s cadence is wrong at both ends: right after an
+unexpected disconnect (range blip, remote rebooting) it leaves the user
+staring at a dead page turner for seconds, and overnight - remote
+switched off - it wakes the radio every 5 seconds for a guaranteed-failed
+attempt.
+
+The scheduler keeps a small state machine per device:
+
+- Aggressive mode after an unexpected disconnect: a handful of short
+  retries, since the remote was alive moments ago. The RSSI of the last
+  advertisement is the signal - a strong link that dropped is almost
+  certainly a blip worth chasing.
+- Exponential decay while the device stays absent: each attempt that
+  never even sees an advertisement doubles the delay, up to
+  reconnect_delay_max.
+- Instant reset the moment the targeted scan sees the device advertise
+  again (or a connection succeeds), so a remote switched back on in the
+  morning is picked up at the base cadence, not after a 5-minute hold.
+
+State survives daemon restarts via a JSON file next to the GATT cache,
+so a crash overnight doesn't restart the burn-battery-every-5s phase.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import asyncio
+import json
+import logging
+import os
+import time
+from typing import Dict
+
+from config import config
+
+__all__ = ['ReconnectScheduler']
+
+logger = logging.getLogger(__name__)
+
+STATE_SCHEMA = 1
+
+# RSSI above this at disconnect time means the remote was close - treat
+# the drop as a blip and retry hard
+_STRONG_RSSI = -75
+
+
+class ReconnectScheduler:
+    """Per-device reconnect delay policy with persisted history."""
+
+    def __init__(self, state_file: str = None):
+        """Initialize the scheduler, restoring persisted state if any.
+
+        Args:
+            state_file: Override for the state file path (tests)
+        """
+        self.state_file = state_file or os.path.join(
+            config.cache_dir, 'reconnect_state.json')
+        self._devices: Dict[str, Dict] = {}
+        self._load()
+
+    def _entry(self, address: str) -> Dict:
+        """Get (or create) the state entry for a device."""
+        entry = self._devices.get(address)
+        if entry is None:
+            entry = {'misses': 0, 'aggressive_left': 0, 'last_result': ''}
+            self._devices[address] = entry
+        return entry
+
+    def note_connected(self, address: str):
+        """A connection was fully established: back to the base cadence."""
+        entry = self._entry(address)
+        entry['misses'] = 0
+        entry['aggressive_left'] = 0
+        entry['last_result'] = 'connected'
+        entry['updated'] = time.time()
+        self._persist()
+
+    def note_disconnected(self, address: str, rssi=None):
+        """A live session dropped unexpectedly: enter aggressive mode.
+
+        Args:
+            address: Device address
+            rssi: RSSI of the last advertisement seen from the device,
+                if known - a strong reading earns the full aggressive
+                burst, a weak or unknown one a shorter burst (the remote
+                probably walked out of range and won't be back in 2s)
+        """
+        entry = self._entry(address)
+        entry['misses'] = 0
+        burst = config.reconnect_aggressive_attempts
+        if rssi is None or rssi < _STRONG_RSSI:
+            burst = max(1, burst // 2)
+        entry['aggressive_left'] = burst
+        entry['last_result'] = 'disconnected'
+        entry['updated'] = time.time()
+        self._persist()
+
+    def note_failure(self, address: str, advertised: bool = False):
+        """A connection attempt failed.
+
+        Args:
+            address: Device address
+            advertised: True if the targeted scan saw the device this
+                cycle - it is present, the failure was in setup, so the
+                backoff is reset instead of escalated
+        """
+        entry = self._entry(address)
+        if entry['aggressive_left'] > 0:
+            entry['aggressive_left'] -= 1
+        if advertised:
+            entry['misses'] = 0
+        else:
+            entry['misses'] += 1
+        entry['last_result'] = 'failed'
+        entry['updated'] = time.time()
+        self._persist()
+
+    def next_delay(self, address: str) -> float:
+        """Delay in seconds before this device's next connection attempt."""
+        if not config.adaptive_reconnect:
+            return float(config.reconnect_delay)
+
+        entry = self._entry(address)
+        if entry['aggressive_left'] > 0:
+            return float(config.reconnect_aggressive_delay)
+        if entry['misses'] == 0:
+            return float(config.reconnect_delay)
+        return float(min(
+            config.reconnect_delay * (2 ** entry['misses']),
+            config.reconnect_delay_max
+        ))
+
+    def _load(self):
+        """Restore persisted state (missing or corrupt file starts fresh)."""
+        try:
+            with open(self.state_file, 'r') as f:
+                data = json.load(f)
+            if data.get('schema') == STATE_SCHEMA:
+                self._devices = data.get('devices', {})
+                logger.info(f"Restored reconnect state for "
+                            f"{len(self._devices)} device(s)")
+        except FileNotFoundError:
+            pass
+        except Exception as e:
+            logger.warning(f"Failed to load reconnect state: {e}")
+
+    def _save(self):
+        """Write state to disk (synchronous - call off the loop)."""
+        try:
+            os.makedirs(os.path.dirname(self.state_file), exist_ok=True)
+            with open(self.state_file, 'w') as f:
+                json.dump({'schema': STATE_SCHEMA,
+                           'devices': self._devices}, f, indent=2)
+        except Exception as e:
+            logger.warning(f"Failed to save reconnect state: {e}")
+
+    def _persist(self):
+        """Schedule a state write without stalling the event loop."""
+        try:
+            loop = asyncio.get_running_loop()
+        except RuntimeError:
+            self._save()
+            return
+        loop.run_in_executor(None, self._save)
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+HID Report Replay Harness
+
+Feeds captured (or synthetic) raw HID reports through the full
+ButtonHandler decode path - decoder, mapper, dispatch table, debounce -
+at a configurable rate and reports sustained reports/sec plus per-report
+CPU time. Runs fine on the Kindle itself, which is where the numbers
+matter: per-report cost must stay well under the 15ms fast connection
+interval or presses queue up behind processing.
+
+Capture a trace first by setting capture_reports = true in config.ini
+([buttons] section); the daemon then appends every raw report to the
+capture file, one "<monotonic_ts> <hex>" line each.
+
+Usage:
+    python3 replay_reports.py                      # synthetic stream
+    python3 replay_reports.py -f cache/report_capture.log
+    python3 replay_reports.py --rate 50 --count 2000
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import argparse
+import sys
+import time
+
+# Add the bumble_ble_hid directory to path for Kindle deployment
+sys.path.insert(0, '/mnt/us/bumble_ble_hid')
+
+from config import config
+from logging_utils import log
+from metrics import metrics, STAGE_DECODE
+from button_handler import ButtonHandler
+
+
+# Synthetic BLE-M3 stream: press/release pairs covering the direct
+# table, the 0x68 movement analysis, and release/noise frames
+SYNTHETIC_STREAM = [
+    bytes([0x01, 0x96, 0x00, 0x00]),  # Left (direct mapping)
+    bytes([0x01, 0x00, 0x00, 0x00]),  # release
+    bytes([0x01, 0x68, 0x00, 0xbc]),  # Up (0x68, y=-68)
+    bytes([0x01, 0x00, 0x00, 0x00]),  # release
+    bytes([0x01, 0x68, 0x00, 0x90]),  # Down (0x68, y=-112)
+    bytes([0x01, 0x00, 0x00, 0x00]),  # release
+    bytes([0x01, 0x68, 0x01, 0x90]),  # Right (0x68, x!=0, y<-50)
+    bytes([0x01, 0x00, 0x00, 0x00]),  # release
+    bytes([0x01, 0xfa, 0x00, 0x00]),  # Right (direct mapping)
+    bytes([0x01, 0x00, 0x00, 0x00]),  # release
+]
+
+
+def load_capture(path):
+    """Load raw reports from a capture file.
+
+    Args:
+        path: Capture file ("<monotonic_ts> <hex>" per line)
+
+    Returns:
+        List of raw report byte strings
+    """
+    reports = []
+    with open(path, 'r') as f:
+        for line_no, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            try:
+                _, hex_data = line.split()
+                reports.append(bytes.fromhex(hex_data))
+            except ValueError:
+                log.warning(f"Skipping malformed line {line_no}: {line}")
+    return reports
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Replay HID reports through the button handler'
+    )
+    parser.add_argument(
+        '-f', '--file',
+        help='Capture file to replay (default: built-in synthetic stream)'
+    )
+    parser.add_argument(
+        '-r', '--rate',
+        type=float,
+        default=0.0,
+        help='Replay rate in reports/sec (0 = as fast as possible)'
+    )
+    parser.add_argument(
+        '-c', '--count',
+        type=int,
+        default=10000,
+        help='Total reports to replay, looping the stream (default: 10000)'
+    )
+    parser.add_argument(
+        '--execute',
+        action='store_true',
+        help='Actually run the mapped scripts (default: count dispatches only)'
+    )
+    parser.add_argument(
+        '--debounce',
+        action='store_true',
+        help='Keep debounce/repeat gating active (default: disabled so '
+             'every report exercises the full path)'
+    )
+    args = parser.parse_args()
+
+    if args.file:
+        stream = load_capture(args.file)
+        if not stream:
+            log.error(f"No reports loaded from {args.file}")
+            return 1
+        log.info(f"Loaded {len(stream)} reports from {args.file}")
+    else:
+        stream = SYNTHETIC_STREAM
+        log.info(f"Using synthetic BLE-M3 stream ({len(stream)} reports/loop)")
+
+    config.capture_reports = False  # never re-capture our own replay
+    handler = ButtonHandler()
+
+    # Measure processing cost, not script cost: swap the dispatch tail
+    # for a counter unless --execute was given
+    dispatched = [0]
+    if not args.execute:
+        handler.shutdown()  # release the executor pool worker
+
+        def _count_dispatch(button_code, button_name, received_at=None):
+            dispatched[0] += 1
+            return True
+        handler._execute_script = _count_dispatch
+        handler.log_button_presses = False
+
+    if not args.debounce:
+        handler.debounce_ms = 0
+        handler.repeat_ms = 0
+
+    interval = 1.0 / args.rate if args.rate > 0 else 0.0
+    total = args.count
+
+    log.info(f"Replaying {total} reports"
+             + (f" at {args.rate:.0f}/sec" if args.rate else " flat out")
+             + "...")
+
+    wall_start = time.monotonic()
+    cpu_start = time.process_time()
+    next_at = wall_start
+
+    for i in range(total):
+        handler.handle_report(stream[i % len(stream)])
+        if interval:
+            next_at += interval
+            delay = next_at - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+
+    wall = time.monotonic() - wall_start
+    cpu = time.process_time() - cpu_start
+
+    decode = metrics.histogram(STAGE_DECODE).snapshot()
+    counters = metrics.snapshot()['counters']
+
+    log.raw("")
+    log.raw("=" * 60)
+    log.raw("Replay results")
+    log.raw("=" * 60)
+    log.raw(f"  reports replayed:   {total}")
+    log.raw(f"  wall time:          {wall:.2f}s "
+            f"({total / wall:.0f} reports/sec sustained)")
+    log.raw(f"  CPU time:           {cpu:.2f}s "
+            f"({cpu / total * 1e6:.0f} us/report)")
+    log.raw(f"  dispatched:         "
+            f"{dispatched[0] if not args.execute else counters.get('scripts_executed', 0)}")
+    log.raw(f"  movement drops:     {counters.get('movement_drops', 0)}")
+    log.raw(f"  coalesced:          {counters.get('reports_coalesced', 0)}")
+    log.raw(f"  debounce drops:     {counters.get('debounce_drops', 0)}")
+    if decode:
+        log.raw(f"  decode latency:     p50={decode['p50_ms']}ms "
+                f"p95={decode['p95_ms']}ms p99={decode['p99_ms']}ms "
+                f"max={decode['max_ms']}ms")
+
+    # The whole point: per-report cost must leave headroom inside one
+    # fast connection interval
+    budget_ms = config.fast_interval_min
+    per_report_ms = cpu / total * 1000.0
+    if per_report_ms > budget_ms:
+        log.error(f"Per-report CPU time {per_report_ms:.2f}ms exceeds the "
+                  f"{budget_ms}ms fast connection interval!")
+        return 1
+
+    log.success(f"Per-report CPU {per_report_ms * 1000:.0f}us, within the "
+                f"{budget_ms}ms interval budget")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
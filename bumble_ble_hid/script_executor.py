@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+Script Executor Pool
+
+Pre-forked worker process that runs button action scripts so the daemon
+never pays fork+exec cost on the report hot path. On the Kindle's single
+Cortex-A9 a fresh subprocess.Popen of a shell script costs 80-150ms; with
+the pool the per-press cost in the daemon is a single pipe write, and the
+small worker process does the actual spawning off the event loop.
+
+The worker is forked at daemon start with the resolved button-code ->
+script table and receives one byte per press over a pipe. If the worker
+dies it is respawned transparently on the next dispatch.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import asyncio
+import os
+import signal
+import subprocess
+import sys
+import time
+from typing import Dict, Optional
+
+from config import config
+from logging_utils import log
+from metrics import metrics
+
+__all__ = ['ScriptExecutorPool', 'ScriptSupervisor', 'script_supervisor']
+
+# Sentinel byte telling the worker to exit cleanly
+_SHUTDOWN_CODE = 0x00
+
+
+class ScriptExecutorPool:
+    """Long-lived script execution worker fed over a pipe.
+
+    The action table (button code -> script path) is fixed at fork time;
+    call restart() with a new table after a configuration change.
+    """
+
+    def __init__(self, action_table: Dict[int, str]):
+        """Initialize the pool (does not fork yet - call start()).
+
+        Args:
+            action_table: Mapping of button code to script path
+        """
+        self.action_table = dict(action_table)
+        self._pid: Optional[int] = None
+        self._write_fd: Optional[int] = None
+
+    def start(self):
+        """Fork the worker process."""
+        read_fd, write_fd = os.pipe()
+        pid = os.fork()
+
+        if pid == 0:
+            # Worker process: only reads the pipe and spawns scripts
+            os.close(write_fd)
+            try:
+                self._worker_loop(read_fd)
+            finally:
+                os._exit(0)
+
+        # Parent
+        os.close(read_fd)
+        self._pid = pid
+        self._write_fd = write_fd
+        log.success(f"Script executor worker started (pid {pid}, "
+                    f"{len(self.action_table)} actions)")
+
+    def dispatch(self, button_code: int) -> bool:
+        """Send a button code to the worker (hot path: one pipe write).
+
+        Args:
+            button_code: Standardized button code (must be 1-255)
+
+        Returns:
+            True if the code was handed to the worker
+        """
+        if button_code <= 0 or button_code > 255:
+            return False
+
+        if button_code not in self.action_table:
+            log.warning(f"No script configured for button 0x{button_code:02x}")
+            return False
+
+        try:
+            os.write(self._write_fd, bytes([button_code]))
+            return True
+        except (OSError, TypeError):
+            # Worker died or pool never started - respawn once and retry
+            log.warning("Script executor worker unavailable, respawning")
+            try:
+                self.restart(self.action_table)
+                os.write(self._write_fd, bytes([button_code]))
+                return True
+            except OSError as e:
+                log.error(f"Script executor dispatch failed: {e}")
+                return False
+
+    def restart(self, action_table: Dict[int, str]):
+        """Stop the worker and fork a new one with a fresh action table."""
+        self.stop()
+        self.action_table = dict(action_table)
+        self.start()
+
+    def stop(self):
+        """Shut the worker down and reap it."""
+        if self._write_fd is not None:
+            try:
+                os.write(self._write_fd, bytes([_SHUTDOWN_CODE]))
+            except OSError:
+                pass
+            try:
+                os.close(self._write_fd)
+            except OSError:
+                pass
+            self._write_fd = None
+
+        if self._pid is not None:
+            try:
+                os.waitpid(self._pid, 0)
+            except ChildProcessError:
+                pass
+            self._pid = None
+
+    def _worker_loop(self, read_fd: int):
+        """Worker main loop: read button codes, spawn mapped scripts.
+
+        Runs in the forked child. Scripts are detached so a slow action
+        never blocks the next press; SIGCHLD is ignored so finished
+        scripts are reaped by the kernel without zombie buildup.
+        """
+        signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+        # Don't react to the daemon's shutdown signals; the parent tells
+        # us to exit via the pipe (or by closing it)
+        signal.signal(signal.SIGTERM, signal.SIG_DFL)
+        signal.signal(signal.SIGINT, signal.SIG_IGN)
+
+        while True:
+            try:
+                data = os.read(read_fd, 1)
+            except OSError:
+                break
+            if not data or data[0] == _SHUTDOWN_CODE:
+                break
+
+            script_path = self.action_table.get(data[0])
+            if not script_path:
+                continue
+
+            try:
+                subprocess.Popen(
+                    [script_path],
+                    stdout=subprocess.DEVNULL,
+                    stderr=subprocess.DEVNULL,
+                    start_new_session=True
+                )
+            except Exception as e:
+                # stderr is redirected into the daemon log by the init script
+                print(f"script executor: failed to run {script_path}: {e}",
+                      file=sys.stderr)
+
+
+class ScriptSupervisor:
+    """Supervised async script launcher for the non-pool path.
+
+    The old direct spawn used subprocess.Popen with PIPE stdout/stderr
+    and never read or waited on the child: a chatty script could fill
+    the 64KB pipe buffer and block mid-action, and finished children
+    stayed un-reaped. The supervisor launches through
+    asyncio.create_subprocess_exec, drains output into the log once the
+    script exits, records per-script runtime and exit status into the
+    metrics surface, and caps concurrent in-flight scripts so a stuck
+    action can't pile processes up on the 256MB device (a script past
+    script_timeout is killed to free its slot).
+
+    Shared as a single instance (`script_supervisor`) so the in-flight
+    cap is global, mirroring the config/log/metrics singletons.
+    """
+
+    def __init__(self):
+        self._inflight = 0
+
+    def launch(self, script_path: str, label: str) -> bool:
+        """Launch a script under supervision (hot path: schedules a task).
+
+        Args:
+            script_path: Resolved script to run
+            label: Short name for logging (button name etc.)
+
+        Returns:
+            True if the script was launched (or handed to a task)
+        """
+        try:
+            asyncio.get_running_loop()
+        except RuntimeError:
+            # CLI tools (main.py scan, replay with --execute) run
+            # handler code without a loop: detached spawn with output
+            # discarded, which at least can't block on a full pipe
+            try:
+                subprocess.Popen(
+                    [script_path],
+                    stdout=subprocess.DEVNULL,
+                    stderr=subprocess.DEVNULL,
+                    start_new_session=True
+                )
+                return True
+            except Exception as e:
+                log.error(f"Failed to execute {label}: {e}")
+                return False
+
+        if self._inflight >= config.max_inflight_scripts:
+            log.warning(f"Dropping {label}: {self._inflight} scripts "
+                        "already in flight")
+            metrics.incr('scripts_rejected')
+            return False
+
+        self._inflight += 1
+        asyncio.ensure_future(self._supervise(script_path, label))
+        return True
+
+    async def _supervise(self, script_path: str, label: str):
+        """Run one script to completion: drain output, reap, record."""
+        name = os.path.basename(script_path)
+        started = time.monotonic()
+
+        try:
+            proc = await asyncio.create_subprocess_exec(
+                script_path,
+                stdout=asyncio.subprocess.PIPE,
+                stderr=asyncio.subprocess.PIPE,
+                start_new_session=True
+            )
+        except Exception as e:
+            self._inflight -= 1
+            metrics.incr('scripts_failed')
+            log.error(f"Failed to execute {label}: {e}")
+            return
+
+        stdout = stderr = b''
+        try:
+            stdout, stderr = await asyncio.wait_for(
+                proc.communicate(), timeout=config.script_timeout
+            )
+        except asyncio.TimeoutError:
+            metrics.incr('script_timeouts')
+            log.warning(f"{name} still running after "
+                        f"{config.script_timeout}s - killing it")
+            # Kill the whole process group (start_new_session made the
+            # script its leader) so children it spawned can't keep the
+            # pipes - and the slot - alive
+            try:
+                os.killpg(proc.pid, signal.SIGKILL)
+            except (ProcessLookupError, PermissionError):
+                pass
+            try:
+                stdout, stderr = await asyncio.wait_for(
+                    proc.communicate(), timeout=5.0
+                )
+            except (asyncio.TimeoutError, Exception):
+                pass
+        finally:
+            self._inflight -= 1
+
+        elapsed = time.monotonic() - started
+        metrics.record_latency(f'script_{name}', elapsed)
+
+        if proc.returncode == 0:
+            metrics.incr('scripts_completed')
+        else:
+            metrics.incr('scripts_failed')
+            log.warning(f"{name} exited with status {proc.returncode} "
+                        f"after {elapsed * 1000:.0f}ms")
+
+        # Drained post-exit, so a chatty script never blocks mid-action;
+        # its output lands in the log instead of a full pipe buffer
+        for line in stdout.decode('utf-8', errors='replace').splitlines():
+            log.detail(f"[{name}] {line}")
+        for line in stderr.decode('utf-8', errors='replace').splitlines():
+            log.warning(f"[{name}] {line}")
+
+
+# Shared instance (global in-flight cap)
+script_supervisor = ScriptSupervisor()
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""
+UHID Keyboard Output Backend
+
+Injects decoded button presses into the kernel as keystrokes through a
+virtual /dev/uhid keyboard, as a low-latency alternative to spawning a
+shell script. For a keystroke-mapped action the press-to-effect path is
+two writes to an already-open fd (key down, key up) instead of
+fork+exec of /bin/sh plus a framework round trip - tens of microseconds
+versus tens to hundreds of milliseconds on the Kindle.
+
+Only actions that really are plain keystrokes (page forward/back) map
+here; anything that needs logic (brightness ramping, tap scripting)
+stays on the script path. See button_handler.py for how the two
+backends are selected per button.
+
+Earlier UHID exploration notes live in docs/archive/DEBUG_UHID.md; the
+descriptor below is the minimal boot-style keyboard that was verified
+to register an input device there.
+
+Author: Lucas Zampieri <lzampier@redhat.com>
+"""
+
+import os
+import struct
+from typing import Optional
+
+from logging_utils import log
+
+__all__ = ['UHIDKeyboard', 'usage_for', 'KEY_USAGES']
+
+# uhid_event types (linux/uhid.h)
+UHID_DESTROY = 1
+UHID_CREATE2 = 11
+UHID_INPUT2 = 12
+
+BUS_BLUETOOTH = 0x05
+HID_MAX_DESCRIPTOR_SIZE = 4096
+
+# Minimal boot-compatible keyboard: 8 modifier bits, 1 reserved byte,
+# 6-key rollover array. Matches what hid-generic binds without fuss.
+_KEYBOARD_DESCRIPTOR = bytes([
+    0x05, 0x01,  # Usage Page (Generic Desktop)
+    0x09, 0x06,  # Usage (Keyboard)
+    0xA1, 0x01,  # Collection (Application)
+    0x05, 0x07,  #   Usage Page (Keyboard)
+    0x19, 0xE0,  #   Usage Minimum (Left Control)
+    0x29, 0xE7,  #   Usage Maximum (Right GUI)
+    0x15, 0x00,  #   Logical Minimum (0)
+    0x25, 0x01,  #   Logical Maximum (1)
+    0x75, 0x01,  #   Report Size (1)
+    0x95, 0x08,  #   Report Count (8)
+    0x81, 0x02,  #   Input (Data, Variable, Absolute)   ; modifiers
+    0x95, 0x01,  #   Report Count (1)
+    0x75, 0x08,  #   Report Size (8)
+    0x81, 0x01,  #   Input (Constant)                   ; reserved
+    0x95, 0x06,  #   Report Count (6)
+    0x75, 0x08,  #   Report Size (8)
+    0x15, 0x00,  #   Logical Minimum (0)
+    0x25, 0x65,  #   Logical Maximum (101)
+    0x05, 0x07,  #   Usage Page (Keyboard)
+    0x19, 0x00,  #   Usage Minimum (0)
+    0x29, 0x65,  #   Usage Maximum (101)
+    0x81, 0x00,  #   Input (Data, Array)                ; key slots
+    0xC0,        # End Collection
+])
+
+# Key names accepted in button_config.json -> HID keyboard usage IDs
+KEY_USAGES = {
+    'enter': 0x28,
+    'space': 0x2C,
+    'right': 0x4F,
+    'left': 0x50,
+    'down': 0x51,
+    'up': 0x52,
+    'pagedown': 0x4E,
+    'pageup': 0x4B,
+}
+
+
+def usage_for(name) -> Optional[int]:
+    """Resolve a config key name to a HID usage ID (None if unknown)."""
+    return KEY_USAGES.get(str(name).lower())
+
+
+class UHIDKeyboard:
+    """Virtual keyboard registered with the kernel via /dev/uhid.
+
+    create() registers the device; press() injects one key-down/key-up
+    pair. All failures degrade gracefully: press() returns False and the
+    caller falls back to the script path.
+    """
+
+    def __init__(self, name: str = 'Kindle BLE HID Keys',
+                 device_path: str = '/dev/uhid'):
+        """Initialize the backend (does not touch the kernel - see create()).
+
+        Args:
+            name: Input device name shown in /proc/bus/input/devices
+            device_path: UHID character device node
+        """
+        self.name = name
+        self.device_path = device_path
+        self.fd: Optional[int] = None
+
+    def create(self):
+        """Open /dev/uhid and register the virtual keyboard.
+
+        Raises:
+            OSError: If the node is missing (no CONFIG_UHID) or the
+                create request is rejected
+        """
+        self.fd = os.open(self.device_path, os.O_RDWR)
+
+        # struct uhid_event { u32 type; struct uhid_create2_req ... }
+        # create2_req: name[128] phys[64] uniq[64] rd_size:u16 bus:u16
+        #              vendor/product/version/country:u32 rd_data[4096]
+        try:
+            event = struct.pack(
+                '<I128s64s64sHHIIII4096s',
+                UHID_CREATE2,
+                self.name.encode('utf-8'),
+                b'bumble:ble-hid',
+                b'',
+                len(_KEYBOARD_DESCRIPTOR),
+                BUS_BLUETOOTH,
+                0x0001,  # vendor
+                0x0001,  # product
+                0x0001,  # version
+                0,       # country
+                _KEYBOARD_DESCRIPTOR,
+            )
+            os.write(self.fd, event)
+        except OSError:
+            os.close(self.fd)
+            self.fd = None
+            raise
+
+        log.success(f"UHID keyboard registered ({self.name})")
+
+    def press(self, usage: int) -> bool:
+        """Inject one keystroke (key down + key up).
+
+        Args:
+            usage: HID keyboard usage ID (see KEY_USAGES)
+
+        Returns:
+            True if both reports were written to the kernel
+        """
+        if self.fd is None:
+            return False
+
+        try:
+            self._send_input(bytes([0, 0, usage, 0, 0, 0, 0, 0]))
+            self._send_input(bytes(8))
+            return True
+        except OSError as e:
+            # Device went away (kernel tore it down); close so the
+            # caller's fallback takes over for good
+            log.warning(f"UHID injection failed, reverting to scripts: {e}")
+            self.close()
+            return False
+
+    def _send_input(self, report: bytes):
+        """Write one UHID_INPUT2 event (full padded struct, as in the
+        canonical uhid-example.c)."""
+        event = (struct.pack('<IH', UHID_INPUT2, len(report))
+                 + report.ljust(HID_MAX_DESCRIPTOR_SIZE, b'\x00'))
+        os.write(self.fd, event)
+
+    def close(self):
+        """Destroy the virtual device and close the fd."""
+        if self.fd is None:
+            return
+        try:
+            os.write(self.fd, struct.pack('<I', UHID_DESTROY))
+        except OSError:
+            pass
+        try:
+            os.close(self.fd)
+        except OSError:
+            pass
+        self.fd = None
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Connection-phase benchmark harness (no Bumble or hardware required)
+
+Drives the real BLEHIDHost/HIDSession code against the mock Bumble
+stack in mock_bumble.py, which charges one simulated round trip per
+HCI/ATT exchange. Reports per-stage wall time and round-trip counts for:
+
+  transport_open, hci_reset, start (power-on etc.), connect, pair,
+  discover_cold, subscribe, and a warm reconnect (discover_warm,
+  subscribe_warm) driven from the GATT cache written by the cold pass.
+
+Round-trip counts are deterministic, so they are diffed exactly against
+baseline.json - that is what catches regressions like an optimization
+accidentally re-introducing serial reads. Wall times are reported for
+context and only warned about (they wobble with machine load).
+
+Usage:
+    python3 tests/bench/bench_connection.py [--update-baseline]
+"""
+
+import asyncio
+import json
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+BASELINE_FILE = os.path.join(BENCH_DIR, 'baseline.json')
+sys.path.insert(0, BENCH_DIR)
+sys.path.insert(0, os.path.join(BENCH_DIR, '..', '..', 'bumble_ble_hid'))
+
+import mock_bumble
+
+# The stubs must be registered before host.py imports bumble
+mock_bumble.install()
+
+from config import config
+
+TARGET = 'AA:BB:CC:DD:EE:FF'
+
+# Point all paths at a scratch directory so the bench never touches
+# /mnt/us or a developer's real cache
+_tmpdir = tempfile.mkdtemp(prefix='ble_hid_bench_')
+config.cache_dir = os.path.join(_tmpdir, 'cache')
+config.pairing_keys_file = os.path.join(_tmpdir, 'pairing_keys.json')
+config.button_config_file = os.path.join(_tmpdir, 'button_config.json')
+config.use_executor_pool = False
+config.log_button_presses = False
+# No advertisements in the mock; connect directly
+config.scan_before_connect = False
+# The bench measures the host-driven establishment path; auto-connect
+# parks the wait in the controller and exchanges nothing to count
+config.auto_connect = False
+
+from host import BLEHIDHost
+
+# Keep the bench output readable: silence the host's console logging
+import logging_utils
+for name in ('info', 'success', 'warning', 'error', 'detail', 'raw'):
+    setattr(logging_utils.log, name, lambda *a, **k: None)
+
+
+class StageTimer:
+    """Collects per-stage wall time and round-trip counts."""
+
+    def __init__(self):
+        self.stages = {}
+
+    async def measure(self, name, coro):
+        mock_bumble.reset_counters()
+        started = time.monotonic()
+        result = await coro
+        elapsed = time.monotonic() - started
+        self.stages[name] = {
+            'ms': round(elapsed * 1000.0, 1),
+            'att_round_trips': mock_bumble.att_round_trips(),
+            'hci_round_trips': mock_bumble.hci_round_trips(),
+        }
+        return result
+
+    def record(self, name, seconds, att=0, hci=0):
+        self.stages[name] = {
+            'ms': round(seconds * 1000.0, 1),
+            'att_round_trips': att,
+            'hci_round_trips': hci,
+        }
+
+
+async def run_benchmark():
+    timer = StageTimer()
+
+    host = BLEHIDHost('mock:bench')
+    # Pre-load bonding keys so pair() takes the encrypted-reconnect path
+    # (the steady-state case we tune for)
+    host.keystore._keys[TARGET] = {'ltk': 'mock'}
+
+    # --- Cold cycle: empty GATT cache, full discovery -------------------
+    host.gatt_cache.clear(TARGET)
+
+    await timer.measure('start', host.start())
+    # Split out the pieces the mock timed internally
+    timer.record('transport_open', mock_bumble.recorded('transport_open'))
+    timer.record('hci_reset', mock_bumble.recorded('hci_reset'), hci=1)
+
+    session = host.session(TARGET)
+    await timer.measure('connect', session.connect())
+    assert session.connection, "connect() failed"
+
+    ok = await timer.measure('pair', session.pair())
+    assert ok, "pair() failed"
+
+    ok = await timer.measure('discover_cold', session.discover_hid_service())
+    assert ok, "cold discovery failed"
+    assert not session._restored_from_cache, \
+        "cold pass unexpectedly hit the cache"
+
+    await timer.measure('subscribe', session.subscribe_to_reports())
+    assert session.hid_reports, "no input reports subscribed"
+
+    # Let the write-behind decoder cache update land before reconnecting
+    await asyncio.sleep(0.1)
+
+    # --- Warm cycle: reconnect driven from the v2 cache entry -----------
+    await session.cleanup()
+    cache = host.gatt_cache.load(TARGET)
+    assert cache and host.gatt_cache.is_complete(cache), \
+        "cold pass did not produce a complete v2 cache entry"
+
+    await timer.measure('connect_warm', session.connect())
+    await timer.measure('pair_warm', session.pair())
+
+    ok = await timer.measure('discover_warm', session.discover_hid_service())
+    assert ok, "warm discovery failed"
+    assert session._restored_from_cache, \
+        "warm pass did not restore from cache"
+
+    await timer.measure('subscribe_warm', session.subscribe_to_reports())
+
+    # --- Bonded fast path: full reconnect with encrypt/setup overlap ----
+    await session.cleanup()
+    # A completed cycle would have set this; the warm pass above drove
+    # the stages individually, so set it explicitly
+    host.gatt_cache.set_bonded(TARGET, True)
+
+    await timer.measure('reconnect_fast', session.connect_and_setup())
+    assert session._restored_from_cache, \
+        "fast reconnect did not restore from cache"
+    assert session.hid_reports, "fast reconnect subscribed no reports"
+
+    await host.cleanup(close_transport=True)
+    return timer.stages
+
+
+def print_report(stages, baseline):
+    print(f"{'stage':<16} {'ms':>8} {'ATT rt':>7} {'HCI rt':>7}   baseline")
+    print("-" * 60)
+    for name, data in stages.items():
+        base = baseline.get(name) if baseline else None
+        base_str = (f"{base['ms']:>6}ms  {base['att_round_trips']} att"
+                    if base else "-")
+        print(f"{name:<16} {data['ms']:>8} {data['att_round_trips']:>7} "
+              f"{data['hci_round_trips']:>7}   {base_str}")
+    print()
+
+
+def compare_to_baseline(stages, baseline):
+    """Diff against the checked-in baseline.
+
+    Returns:
+        Number of hard regressions (round-trip count increases)
+    """
+    regressions = 0
+    for name, base in baseline.items():
+        current = stages.get(name)
+        if current is None:
+            print(f"MISSING stage vs baseline: {name}")
+            regressions += 1
+            continue
+
+        for key in ('att_round_trips', 'hci_round_trips'):
+            if current[key] > base[key]:
+                print(f"REGRESSION {name}: {key} {base[key]} -> {current[key]}")
+                regressions += 1
+            elif current[key] < base[key]:
+                print(f"IMPROVED {name}: {key} {base[key]} -> {current[key]} "
+                      "(update baseline.json)")
+
+        if base['ms'] > 0 and current['ms'] > base['ms'] * 1.5:
+            print(f"WARN {name}: wall time {base['ms']}ms -> {current['ms']}ms "
+                  "(informational only)")
+
+    for name in stages:
+        if name not in baseline:
+            print(f"NEW stage not in baseline: {name} (update baseline.json)")
+
+    return regressions
+
+
+def main():
+    update = '--update-baseline' in sys.argv
+
+    print("=" * 60)
+    print("Connection-Phase Benchmark (mock transport, "
+          f"RTT={mock_bumble.RTT_S * 1000:.0f}ms)")
+    print("=" * 60)
+
+    stages = asyncio.run(run_benchmark())
+
+    baseline = None
+    if os.path.exists(BASELINE_FILE):
+        with open(BASELINE_FILE, 'r') as f:
+            baseline = json.load(f)
+
+    print_report(stages, baseline)
+
+    # The headline comparison: warm reconnect must stay discovery-free
+    warm_att = stages['discover_warm']['att_round_trips']
+    cold_att = stages['discover_cold']['att_round_trips']
+    print(f"discover: cold={cold_att} ATT round trips, warm={warm_att}")
+    assert warm_att == 0, \
+        f"warm discovery performed {warm_att} ATT round trips (expected 0)"
+
+    shutil.rmtree(_tmpdir, ignore_errors=True)
+
+    if update or baseline is None:
+        with open(BASELINE_FILE, 'w') as f:
+            json.dump(stages, f, indent=2)
+            f.write('\n')
+        print(f"Baseline written to {BASELINE_FILE}")
+        return 0
+
+    regressions = compare_to_baseline(stages, baseline)
+    if regressions:
+        print(f"\n{regressions} regression(s) vs baseline")
+        return 1
+
+    print("\nAll stages within baseline")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
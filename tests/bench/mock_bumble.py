@@ -0,0 +1,409 @@
+#!/usr/bin/env python3
+"""
+Mock Bumble stack for off-device benchmarking
+
+Installs stub bumble.* modules into sys.modules (before host.py is
+imported) that replay a BLE-M3-style HID peripheral. Every HCI command
+and ATT request costs one simulated round trip (an asyncio.sleep of
+RTT_S), so stage timings scale the same way they do on hardware: fewer
+round trips = faster stage. The module also keeps per-stage counters so
+benchmarks can assert on the deterministic round-trip counts instead of
+wall time alone.
+"""
+
+import asyncio
+import sys
+import time
+import types
+
+# Simulated round-trip time per HCI/ATT exchange. Real connection
+# intervals are 15-100ms; 5ms keeps the bench fast while still making
+# round trips dominate stage wall time.
+RTT_S = 0.005
+
+# Event log: list of (kind, name, seconds). Benchmarks reset this
+# between stages via reset_counters().
+events = []
+
+
+def reset_counters():
+    """Clear the recorded events (call between benchmark stages)."""
+    del events[:]
+
+
+def att_round_trips():
+    """Number of ATT round trips since the last reset."""
+    return sum(1 for kind, _, _ in events if kind == 'att')
+
+
+def hci_round_trips():
+    """Number of HCI command round trips since the last reset."""
+    return sum(1 for kind, _, _ in events if kind == 'hci')
+
+
+def recorded(name):
+    """Total recorded seconds for a named event (e.g. 'transport_open')."""
+    return sum(s for _, n, s in events if n == name)
+
+
+async def _roundtrip(kind, name):
+    started = time.monotonic()
+    await asyncio.sleep(RTT_S)
+    events.append((kind, name, time.monotonic() - started))
+
+
+# ---------------------------------------------------------------------------
+# GATT data model (mirrors the attributes host.py touches)
+# ---------------------------------------------------------------------------
+
+class UUID:
+    """16-bit UUID stand-in with the operations host.py uses."""
+
+    def __init__(self, value):
+        if isinstance(value, str):
+            # Accept the full 128-bit form produced by _char_to_cache
+            value = int(value[4:8], 16)
+        self.value = value
+
+    @staticmethod
+    def from_16_bits(value):
+        return UUID(value)
+
+    def to_hex_str(self):
+        return f'{self.value:04X}'
+
+    def __eq__(self, other):
+        return isinstance(other, UUID) and self.value == other.value
+
+    def __hash__(self):
+        return hash(self.value)
+
+    def __str__(self):
+        return f'UUID-16:{self.value:04X}'
+
+
+class Service:
+    def __init__(self, uuid, characteristics, primary=True):
+        self.uuid = uuid
+        self.characteristics = characteristics
+        self.primary = primary
+        self.handle = 0
+        self.end_group_handle = 0
+
+
+class Characteristic:
+    def __init__(self, uuid, properties=0, permissions=0, value=b''):
+        self.uuid = uuid
+        self.properties = properties
+        self.permissions = permissions
+        self.value = value
+        self.handle = 0
+        self.end_group_handle = 0
+        self.service = None
+        self.descriptors = []
+        self.descriptors_discovered = False
+
+
+class Descriptor:
+    def __init__(self, attribute_type, permissions=0, value=b''):
+        self.type = attribute_type
+        self.attribute_type = attribute_type
+        self.permissions = permissions
+        self.value = value
+        self.handle = 0
+        self.characteristic = None
+
+
+# Simulated peripheral: BLE-M3-style one-service HID mouse.
+# Report map: report ID 1, 3 buttons (1 byte) + X/Y (1 byte each).
+REPORT_MAP = bytes.fromhex(
+    '05010902a1018501'  # Usage Page/Usage (mouse), Collection, Report ID 1
+    '0901a100'          # Usage (Pointer), Collection (Physical)
+    '05091901290315002501'  # Button page, usages 1-3, logical 0..1
+    '950375018102'      # 3 bits of buttons, Input (Data,Var,Abs)
+    '950175058101'      # 5 bits of padding, Input (Const)
+    '050109300931'      # Generic Desktop, X, Y
+    '1581257f75089502'  # logical -127..127, 8 bits x 2
+    '8106'              # Input (Data,Var,Rel)
+    'c0c0'
+)
+DEVICE_NAME = b'BLE-M3 Mock'
+HID_INFO = bytes.fromhex('01010002')  # bcdHID 1.01, not localized, mouse flags
+
+
+def _build_peripheral():
+    """Construct the simulated remote attribute database."""
+    gap = Service(UUID(0x1800), [], primary=True)
+    gap.handle = 0x0001
+    gap.end_group_handle = 0x0005
+    name_char = Characteristic(UUID(0x2A00), value=DEVICE_NAME)
+    name_char.handle = 0x0003
+    gap._chars = [name_char]
+
+    hid = Service(UUID(0x1812), [], primary=True)
+    hid.handle = 0x0010
+    hid.end_group_handle = 0x0030
+    chars = []
+
+    info = Characteristic(UUID(0x2A4A), value=HID_INFO)
+    info.handle = 0x0012
+    chars.append(info)
+
+    rmap = Characteristic(UUID(0x2A4B), value=REPORT_MAP)
+    rmap.handle = 0x0014
+    chars.append(rmap)
+
+    # Three Report characteristics: one input, one output, one feature
+    for i, (handle, report_type) in enumerate(
+            [(0x0016, 1), (0x0019, 2), (0x001C, 3)]):
+        report = Characteristic(UUID(0x2A4D))
+        report.handle = handle
+        ref = Descriptor(UUID(0x2908), value=bytes([i + 1, report_type]))
+        ref.handle = handle + 2
+        cccd = Descriptor(UUID(0x2902), value=b'\x00\x00')
+        cccd.handle = handle + 1
+        report._descs = [cccd, ref]
+        chars.append(report)
+
+    hid._chars = chars
+    return [gap, hid]
+
+
+# ---------------------------------------------------------------------------
+# Device / connection / transport stubs
+# ---------------------------------------------------------------------------
+
+class Address:
+    def __init__(self, address, address_type=1):
+        self.address = address
+        self.address_type = address_type
+
+    def __str__(self):
+        return self.address
+
+
+Address.ANY = Address('00:00:00:00:00:00', address_type=0)
+
+
+class HCI_Reset_Command:
+    pass
+
+
+class HCI_Read_Local_Version_Information_Command:
+    pass
+
+
+class _HCICommand:
+    """Generic HCI command stub (parameters kept for inspection)."""
+
+    def __init__(self, **kwargs):
+        self.kwargs = kwargs
+
+
+class HCI_LE_Create_Connection_Command(_HCICommand):
+    pass
+
+
+class HCI_LE_Create_Connection_Cancel_Command(_HCICommand):
+    pass
+
+
+class HCI_LE_Clear_Filter_Accept_List_Command(_HCICommand):
+    pass
+
+
+class HCI_LE_Add_Device_To_Filter_Accept_List_Command(_HCICommand):
+    pass
+
+
+class _HciHost:
+    async def send_command(self, command):
+        name = ('hci_reset' if isinstance(command, HCI_Reset_Command)
+                else 'hci_command')
+        await _roundtrip('hci', name)
+
+
+class Connection:
+    def __init__(self, device, peer_address):
+        self.device = device
+        self.peer_address = peer_address
+        self._listeners = {}
+
+    def on(self, event, callback):
+        self._listeners[event] = callback
+
+    async def update_parameters(self, **kwargs):
+        await _roundtrip('hci', 'update_parameters')
+
+    async def encrypt(self):
+        # LTK lookup + LE Start Encryption exchange
+        await _roundtrip('hci', 'encrypt')
+        await _roundtrip('hci', 'encrypt')
+
+    async def pair(self):
+        # Full SMP pairing is many exchanges; model it as expensive
+        for _ in range(6):
+            await _roundtrip('att', 'pair')
+
+    async def disconnect(self):
+        await _roundtrip('hci', 'disconnect')
+
+
+class Device:
+    def __init__(self):
+        self.keystore = None
+        self.pairing_config_factory = None
+        self.public_address = 'F0:F0:F0:F0:F0:F0'
+        self.host = _HciHost()
+        self._listeners = {}
+        self._attribute_db = _build_peripheral()
+
+    @staticmethod
+    def with_hci(name, address, source, sink):
+        return Device()
+
+    def on(self, event, callback):
+        self._listeners[event] = callback
+
+    def remove_listener(self, event, callback):
+        self._listeners.pop(event, None)
+
+    async def power_on(self):
+        await _roundtrip('hci', 'power_on')
+
+    async def start_scanning(self, active=True, filter_duplicates=True):
+        await _roundtrip('hci', 'start_scanning')
+
+    async def stop_scanning(self):
+        await _roundtrip('hci', 'stop_scanning')
+
+    async def connect(self, target):
+        await _roundtrip('hci', 'connect')
+        return Connection(self, target)
+
+
+class Peer:
+    """ATT client view of the simulated peripheral."""
+
+    def __init__(self, connection):
+        self.connection = connection
+        self.services = []
+
+    async def discover_services(self):
+        # Primary service discovery walks the handle range
+        await _roundtrip('att', 'discover_services')
+        await _roundtrip('att', 'discover_services')
+        self.services = list(self.connection.device._attribute_db)
+
+    async def discover_characteristics(self, service=None):
+        await _roundtrip('att', 'discover_characteristics')
+        service.characteristics = list(service._chars)
+
+    async def discover_descriptors(self, characteristic=None):
+        await _roundtrip('att', 'discover_descriptors')
+        characteristic.descriptors = list(
+            getattr(characteristic, '_descs', []))
+
+    async def read_value(self, attribute):
+        await _roundtrip('att', 'read_value')
+        return attribute.value
+
+    async def subscribe(self, characteristic, callback):
+        # CCCD write
+        await _roundtrip('att', 'subscribe')
+
+
+class _Transport:
+    def __init__(self):
+        self.source = object()
+        self.sink = object()
+
+    async def close(self):
+        pass
+
+
+async def open_transport(spec):
+    # Opening /dev/stpbt and settling the MTK controller takes a while
+    started = time.monotonic()
+    await asyncio.sleep(RTT_S * 4)
+    events.append(('io', 'transport_open', time.monotonic() - started))
+    return _Transport()
+
+
+class PairingDelegate:
+    DISPLAY_OUTPUT_AND_YES_NO_INPUT = 4
+
+    def __init__(self, io_capability=None):
+        self.io_capability = io_capability
+
+
+class PairingConfig:
+    def __init__(self, **kwargs):
+        self.options = kwargs
+
+
+class JsonKeyStore:
+    """In-memory keystore pre-loaded with keys for the mock peripheral."""
+
+    def __init__(self, namespace=None, filename=None):
+        self.filename = filename
+        self._keys = {}
+
+    async def get(self, name):
+        return self._keys.get(name)
+
+    async def get_all(self):
+        return list(self._keys.items())
+
+    async def update(self, name, keys):
+        self._keys[name] = keys
+
+    async def delete(self, name):
+        self._keys.pop(name, None)
+
+
+class AdvertisingData:
+    COMPLETE_LOCAL_NAME = 0x09
+    SHORTENED_LOCAL_NAME = 0x08
+    COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS = 0x03
+    INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS = 0x02
+
+
+def _module(name, **attrs):
+    mod = types.ModuleType(name)
+    for key, value in attrs.items():
+        setattr(mod, key, value)
+    sys.modules[name] = mod
+    return mod
+
+
+def install():
+    """Register the stub bumble modules (call before importing host)."""
+    root = _module('bumble')
+    root.__path__ = []
+    _module('bumble.device', Device=Device, Peer=Peer)
+    _module('bumble.hci',
+            Address=Address,
+            HCI_Reset_Command=HCI_Reset_Command,
+            HCI_Read_Local_Version_Information_Command=(
+                HCI_Read_Local_Version_Information_Command),
+            HCI_LE_Create_Connection_Command=HCI_LE_Create_Connection_Command,
+            HCI_LE_Create_Connection_Cancel_Command=(
+                HCI_LE_Create_Connection_Cancel_Command),
+            HCI_LE_Clear_Filter_Accept_List_Command=(
+                HCI_LE_Clear_Filter_Accept_List_Command),
+            HCI_LE_Add_Device_To_Filter_Accept_List_Command=(
+                HCI_LE_Add_Device_To_Filter_Accept_List_Command))
+    _module('bumble.gatt',
+            GATT_GENERIC_ACCESS_SERVICE=UUID(0x1800),
+            GATT_DEVICE_NAME_CHARACTERISTIC=UUID(0x2A00),
+            Characteristic=Characteristic,
+            Descriptor=Descriptor,
+            Service=Service)
+    _module('bumble.transport', open_transport=open_transport)
+    _module('bumble.core', UUID=UUID, AdvertisingData=AdvertisingData)
+    _module('bumble.pairing',
+            PairingConfig=PairingConfig,
+            PairingDelegate=PairingDelegate)
+    _module('bumble.keys', JsonKeyStore=JsonKeyStore)
+    _module('bumble.colors', color=lambda text, c=None: text)